@@ -0,0 +1,158 @@
+# Generates subset fonts for the UI before the build.
+#
+# The built-in Montserrat fonts hold all of ASCII plus ~60 symbols for each
+# size. Most sizes here only ever show the strings in src/ui, digits and a
+# couple of symbols, and the SOC label only shows digits and '%'. This script
+# collects the characters the UI source actually uses and runs lv_font_conv
+# (npm) over LVGL's own Montserrat/FontAwesome files to build just those
+# glyphs into src/ui/fonts/. It prints the glyph data size of each subset
+# next to the same size with the full built-in range.
+#
+# The fonts are only used when generation succeeds: UI_SUBSET_FONTS=1 is
+# then defined, see src/ui/fonts.h. Without node/lv_font_conv the build
+# falls back to the built-in fonts.
+#
+# Called from PlatformIO, defined in platformio.ini as:
+# extra_scripts = pre:gen_fonts.py
+# It can also be run by hand: python gen_fonts.py [path/to/lvgl]
+
+import glob
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+UI_SOURCES = "src/ui/*.cpp"
+OUT_DIR = os.path.join("src", "ui", "fonts")
+
+# Always available to formatted values
+NUMERIC = "0123456789.,-+:% "
+
+# FontAwesome code points of the LV_SYMBOL_* the UI uses
+SYMBOL_CLOSE = 0xF00D
+SYMBOL_BACKSPACE = 0xF55A
+SYMBOL_SETTINGS = 0xF013
+SYMBOL_WARNING = 0xF071
+
+# name, size, characters ("ui" = every character in UI string literals), symbols
+# The 14 px default font stays built-in: it shows scanned BLE device names.
+# Fonts are not compressed, LV_USE_FONT_COMPRESSED is 0 in lv_conf.h.
+FONTS = [
+    ("font_ui_10", 10, "ui", []),
+    ("font_ui_12", 12, "ui", []),
+    ("font_ui_18", 18, "ui", [SYMBOL_CLOSE, SYMBOL_BACKSPACE, SYMBOL_SETTINGS, SYMBOL_WARNING]),
+    # Digit strip for the SOC label
+    ("font_soc_28", 28, NUMERIC, []),
+]
+
+FULL_ASCII = "0x20-0x7F"
+FULL_SYMBOLS = "0xF001,0xF008,0xF00B,0xF00C,0xF00D,0xF011,0xF013,0xF015,0xF019,0xF01C,0xF021,0xF026-0xF028,0xF03E,0xF043,0xF048,0xF04B,0xF04C,0xF04D,0xF051,0xF052,0xF053,0xF054,0xF067,0xF068,0xF06E,0xF070,0xF071,0xF074,0xF077,0xF078,0xF079,0xF07B,0xF093,0xF095,0xF0C4,0xF0C5,0xF0C7,0xF0E7,0xF0EA,0xF0F3,0xF11C,0xF124,0xF158,0xF1EB,0xF240-0xF244,0xF287,0xF293,0xF2ED,0xF304,0xF55A,0xF7C2,0xF8A2"
+
+
+def ui_characters(project_dir):
+    chars = set(NUMERIC)
+    literal = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+    for path in glob.glob(os.path.join(project_dir, UI_SOURCES)):
+        with open(path, encoding="utf-8") as f:
+            for text in literal.findall(f.read()):
+                chars.update(c for c in text if 0x20 <= ord(c) < 0x7F)
+    chars.discard("\\")
+    return "".join(sorted(chars))
+
+
+def find_lvgl(project_dir):
+    candidates = glob.glob(os.path.join(project_dir, ".pio", "libdeps", "*", "lvgl"))
+    for lvgl in candidates:
+        if os.path.isdir(os.path.join(lvgl, "scripts", "built_in_font")):
+            return lvgl
+    return None
+
+
+def lv_font_conv():
+    exe = shutil.which("lv_font_conv")
+    if exe:
+        return [exe]
+    npx = shutil.which("npx")
+    return [npx, "--yes", "lv_font_conv"] if npx else None
+
+
+def glyph_bytes(c_file):
+    # Size of the glyph bitmaps and descriptors, which is what the font costs in flash
+    with open(c_file, encoding="utf-8") as f:
+        src = f.read()
+    bitmap = re.search(r"glyph_bitmap\[\]\s*=\s*\{(.*?)\};", src, re.S)
+    dsc = re.search(r"glyph_dsc\[\]\s*=\s*\{(.*?)\};", src, re.S)
+    size = len(re.findall(r"0x[0-9a-fA-F]{2}", bitmap.group(1))) if bitmap else 0
+    size += 8 * (dsc.group(1).count("{") if dsc else 0)
+    return size
+
+
+def convert(conv, font_dir, name, size, chars, symbols, out):
+    cmd = conv + [
+        "--bpp", "4", "--size", str(size), "--format", "lvgl", "--no-compress",
+        "--lv-include", "lvgl.h", "--lv-font-name", name, "-o", out,
+        "--font", os.path.join(font_dir, "Montserrat-Medium.ttf"),
+    ]
+    cmd += ["-r", chars] if chars.startswith("0x") else ["--symbols", chars]
+    if symbols:
+        cmd += ["--font", os.path.join(font_dir, "FontAwesome5-Solid+Brands+Regular.woff"), "-r", symbols]
+    subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL)
+
+
+def up_to_date(project_dir, out_dir):
+    # Regenerate when UI strings or this script change
+    sources = glob.glob(os.path.join(project_dir, UI_SOURCES))
+    sources.append(os.path.join(project_dir, "gen_fonts.py"))
+    outputs = [os.path.join(out_dir, f[0] + ".c") for f in FONTS]
+    if not all(os.path.exists(o) for o in outputs):
+        return False
+    return min(os.path.getmtime(o) for o in outputs) > max(os.path.getmtime(s) for s in sources)
+
+
+def generate(project_dir, lvgl_dir=None):
+    out_dir = os.path.join(project_dir, OUT_DIR)
+    if up_to_date(project_dir, out_dir):
+        return True
+
+    conv = lv_font_conv()
+    lvgl_dir = lvgl_dir or find_lvgl(project_dir)
+    if not conv or not lvgl_dir:
+        print("gen_fonts: lv_font_conv or LVGL sources not found, using built-in fonts")
+        return False
+
+    font_dir = os.path.join(lvgl_dir, "scripts", "built_in_font")
+    os.makedirs(out_dir, exist_ok=True)
+    ui_chars = ui_characters(project_dir)
+    scratch = os.path.join(project_dir, ".pio", "font_full.c")
+
+    try:
+        for name, size, chars, symbols in FONTS:
+            out = os.path.join(out_dir, name + ".c")
+            text = ui_chars if chars == "ui" else chars
+            syms = ",".join(hex(s) for s in symbols)
+            convert(conv, font_dir, name, size, text, syms, out)
+
+            # Same size with the built-in range, for comparison
+            convert(conv, font_dir, "font_full", size, FULL_ASCII, FULL_SYMBOLS, scratch)
+            print("gen_fonts: %s: %d glyphs, %d bytes (built-in %d px: %d bytes)" % (
+                name, len(text) + len(symbols), glyph_bytes(out), size, glyph_bytes(scratch)))
+    except (subprocess.CalledProcessError, OSError) as e:
+        print("gen_fonts: lv_font_conv failed (%s), using built-in fonts" % e)
+        for name, *_ in FONTS:
+            path = os.path.join(out_dir, name + ".c")
+            if os.path.exists(path):
+                os.remove(path)
+        return False
+    finally:
+        if os.path.exists(scratch):
+            os.remove(scratch)
+    return True
+
+
+if __name__ == "__main__":
+    sys.exit(0 if generate(os.getcwd(), sys.argv[1] if len(sys.argv) > 1 else None) else 1)
+else:
+    Import("env")
+    if generate(env["PROJECT_DIR"]):
+        env.Append(CPPDEFINES=[("UI_SUBSET_FONTS", 1)])
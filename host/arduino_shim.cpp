@@ -0,0 +1,92 @@
+#include <Arduino.h>
+#include <chrono>
+#include <vector>
+
+HostSerial Serial;
+EspClass ESP;
+
+static const auto startTime = std::chrono::steady_clock::now();
+static unsigned long skippedMicros = 0;
+
+unsigned long micros() {
+  auto elapsed = std::chrono::steady_clock::now() - startTime;
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() + skippedMicros;
+}
+
+unsigned long millis() {
+  return micros() / 1000;
+}
+
+void delay(unsigned long ms) {
+  skippedMicros += ms * 1000;
+}
+
+#if defined(__GLIBC__) && (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)
+size_t strlcpy(char *dst, const char *src, size_t size) {
+  size_t len = strlen(src);
+  if (size > 0) {
+    size_t n = len < size - 1 ? len : size - 1;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+  }
+  return len;
+}
+#endif
+
+int HostSerial::printf(const char *format, ...) {
+  if (!enabled) return 0;
+  va_list args;
+  va_start(args, format);
+  int n = vprintf(format, args);
+  va_end(args);
+  return n;
+}
+
+size_t HostSerial::print(const char *text) {
+  if (!enabled) return 0;
+  return fputs(text, stdout) < 0 ? 0 : strlen(text);
+}
+
+size_t HostSerial::print(long value) {
+  return enabled ? ::printf("%ld", value) : 0;
+}
+
+size_t HostSerial::print(unsigned long value) {
+  return enabled ? ::printf("%lu", value) : 0;
+}
+
+size_t HostSerial::print(double value) {
+  return enabled ? ::printf("%.2f", value) : 0;
+}
+
+struct HostQueue {
+  std::vector<uint8_t> items;
+  unsigned itemSize;
+  unsigned length;
+  unsigned head = 0;
+  unsigned count = 0;
+};
+
+QueueHandle_t xQueueCreate(unsigned length, unsigned itemSize) {
+  HostQueue *queue = new HostQueue;
+  queue->items.resize((size_t)length * itemSize);
+  queue->itemSize = itemSize;
+  queue->length = length;
+  return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait) {
+  if (queue->count == queue->length) return pdFALSE;
+  unsigned tail = (queue->head + queue->count) % queue->length;
+  memcpy(&queue->items[(size_t)tail * queue->itemSize], item, queue->itemSize);
+  queue->count++;
+  return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait) {
+  if (queue->count == 0) return pdFALSE;
+  memcpy(item, &queue->items[(size_t)queue->head * queue->itemSize], queue->itemSize);
+  queue->head = (queue->head + 1) % queue->length;
+  queue->count--;
+  return pdTRUE;
+}
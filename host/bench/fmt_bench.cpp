@@ -0,0 +1,96 @@
+// Compares the fixed-point formatter in src/utils/fixed_fmt with the printf
+// paths the UI used before, on the dashboard's voltage/current line and a
+// cell voltage table value, and checks that both produce the same text.
+//
+//   pio run -e native_fmt && .pio/build/native_fmt/program [iterations]
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include "../../src/utils/fixed_fmt.h"
+
+static volatile size_t sink;  // Keeps the optimizer from dropping the work
+
+// What lv_label_set_text_fmt() does: measure, allocate, format
+static void lvgl_style_fmt(const char *fmt, ...) {
+  va_list args, copy;
+  va_start(args, fmt);
+  va_copy(copy, args);
+  int len = vsnprintf(nullptr, 0, fmt, copy);
+  va_end(copy);
+  char *text = (char *)malloc(len + 1);
+  vsnprintf(text, len + 1, fmt, args);
+  va_end(args);
+  sink += text[len - 1];
+  free(text);
+}
+
+static int32_t sample_mv(int i) { return 48000 + (i * 7919) % 10000; }
+static int32_t sample_ma(int i) { return -150000 + (i * 104729) % 300000; }
+static int32_t sample_cell(int i) { return 3000 + (i * 31) % 650; }
+
+// ns per call
+static double timed(int iterations, void (*fn)(int)) {
+  unsigned long start = micros();
+  for (int i = 0; i < iterations; i++) fn(i);
+  return (micros() - start) * 1000.0 / iterations;
+}
+
+static void va_float_printf(int i) {
+  lvgl_style_fmt("V: %.2f   A: %.3f", sample_mv(i) * 0.001f, sample_ma(i) * 0.001f);
+}
+
+static void va_fixed(int i) {
+  static FixedText<32> text;
+  text.clear().add("V: ").add(sample_mv(i), 3, 2).add("   A: ").add(sample_ma(i), 3, 3);
+  sink += text.len;
+}
+
+static void cell_int_printf(int i) {
+  int32_t v = sample_cell(i);
+  lvgl_style_fmt("%s%ld.%03ld", v < 0 ? "-" : "", labs(v) / 1000, labs(v) % 1000);
+}
+
+static void cell_fixed(int i) {
+  char text[16];
+  sink += fixed_format(text, sizeof(text), sample_cell(i), 3, 3);
+}
+
+// Same text as printf for every value that is not an exact rounding tie,
+// where printf rounds to even and fixed_format away from zero
+static bool check(int iterations) {
+  bool ok = true;
+  char fixed[32], expected[32];
+  for (int i = 0; i < iterations; i++) {
+    int32_t ma = sample_ma(i) + i % 7;
+    for (int decimals = 0; decimals <= 3; decimals++) {
+      int32_t drop = decimals == 3 ? 1 : decimals == 2 ? 10 : decimals == 1 ? 100 : 1000;
+      if (drop > 1 && labs(ma) % drop == drop / 2) continue;
+      fixed_format(fixed, sizeof(fixed), ma, 3, decimals);
+      snprintf(expected, sizeof(expected), "%.*f", decimals, ma / 1000.0);
+      if (strcmp(fixed, expected)) {
+        fprintf(stderr, "FAIL %ld, %d decimals: \"%s\", printf \"%s\"\n", (long)ma, decimals, fixed, expected);
+        ok = false;
+      }
+    }
+  }
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  int iterations = argc > 1 ? atoi(argv[1]) : 1000000;
+  if (iterations < 1) iterations = 1;
+
+  double vaPrintf = timed(iterations, va_float_printf);
+  double vaFixed = timed(iterations, va_fixed);
+  double cellPrintf = timed(iterations, cell_int_printf);
+  double cellFixed = timed(iterations, cell_fixed);
+
+  printf("%-28s %10s %10s %8s\n", "text", "printf ns", "fixed ns", "speedup");
+  printf("%-28s %10.1f %10.1f %7.1fx\n", "V/A line (%.2f, %.3f)", vaPrintf, vaFixed, vaPrintf / vaFixed);
+  printf("%-28s %10.1f %10.1f %7.1fx\n", "cell value (%ld.%03ld)", cellPrintf, cellFixed, cellPrintf / cellFixed);
+
+  bool ok = check(iterations / 10 + 1);
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+// Minimal Arduino API for the native (Linux) build.
+// Only what the protocol code in src/bms, src/utils/utils.h and, for the
+// headless UI build, the UI command queue need.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <strings.h>
+#include <string>
+
+typedef uint8_t byte;
+typedef std::string String;
+
+// millis()/micros() follow the real clock plus any time skipped by delay(),
+// so host runs do not sleep through the BMS init delays
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+#if defined(__GLIBC__) && (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)
+size_t strlcpy(char *dst, const char *src, size_t size);
+#endif
+
+// Serial replacement writing to stdout. Output can be muted for benchmarks.
+class HostSerial {
+public:
+  bool enabled = true;
+
+  void begin(unsigned long baud) {}
+  int printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+  size_t print(const char *text);
+  size_t print(const std::string &text) { return print(text.c_str()); }
+  size_t print(int value) { return print((long)value); }
+  size_t print(unsigned int value) { return print((unsigned long)value); }
+  size_t print(long value);
+  size_t print(unsigned long value);
+  size_t print(double value);
+  size_t println() { return print("\n"); }
+  template <typename T>
+  size_t println(const T &value) { return print(value) + println(); }
+};
+
+extern HostSerial Serial;
+
+// Heap figures for the diagnostics screen, the host has none to report
+struct EspClass {
+  uint32_t getFreeHeap() { return 0; }
+  uint32_t getMinFreeHeap() { return 0; }
+  uint32_t getHeapSize() { return 0; }
+  uint32_t getMaxAllocHeap() { return 0; }
+};
+extern EspClass ESP;
+
+// FreeRTOS queues as used by src/ui/ui_queue.cpp. Host builds are single
+// threaded, so these never block and the wait time is ignored.
+typedef struct HostQueue *QueueHandle_t;
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+#define pdTRUE 1
+#define pdFALSE 0
+
+QueueHandle_t xQueueCreate(unsigned length, unsigned itemSize);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t wait);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t wait);
+
+// Critical sections as used by src/bms/registry.cpp, no-ops single threaded
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
@@ -0,0 +1,144 @@
+#include "jk_frames.h"
+#include <string.h>
+#include "../src/bms/jkbms.h"
+
+static void put_u16(uint8_t *p, uint16_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+}
+
+static void put_u32(uint8_t *p, uint32_t v) {
+  p[0] = v;
+  p[1] = v >> 8;
+  p[2] = v >> 16;
+  p[3] = v >> 24;
+}
+
+static void put_text(uint8_t *p, const char *text, size_t size) {
+  size_t n = strlen(text);
+  memcpy(p, text, n < size ? n : size);
+}
+
+static void begin_frame(uint8_t *frame, uint8_t type, uint8_t counter) {
+  memset(frame, 0, JK_FRAME_SIZE);
+  frame[0] = 0x55;
+  frame[1] = 0xAA;
+  frame[2] = 0xEB;
+  frame[3] = 0x90;
+  frame[4] = type;
+  frame[5] = counter;
+}
+
+static void end_frame(uint8_t *frame) {
+  uint8_t sum = 0;
+  for (int i = 0; i < JK_FRAME_SIZE - 1; i++) sum += frame[i];
+  frame[JK_FRAME_SIZE - 1] = sum;
+}
+
+void jk_build_cell_info(uint8_t *frame, const JkCellInfo &info, uint8_t counter) {
+  begin_frame(frame, JK_FRAME_CELL_INFO, counter);
+
+  uint32_t sum = 0;
+  uint16_t lo = 0xFFFF, hi = 0;
+  for (int i = 0; i < info.cellCount; i++) {
+    put_u16(frame + 6 + i * 2, info.cellMv[i]);
+    sum += info.cellMv[i];
+    if (info.cellMv[i] < lo) lo = info.cellMv[i];
+    if (info.cellMv[i] > hi) hi = info.cellMv[i];
+  }
+  if (info.cellCount > 0) {
+    put_u16(frame + 74, sum / info.cellCount);
+    put_u16(frame + 76, hi - lo);
+  }
+  for (int i = 0; i < 16; i++) put_u16(frame + 80 + i * 2, info.wireResistMohm[i]);
+
+  put_u16(frame + 144, (uint16_t)info.mosDeciC);
+  put_u32(frame + 150, (uint32_t)info.packMv);
+  put_u32(frame + 158, (uint32_t)info.currentMa);
+  put_u16(frame + 162, (uint16_t)info.t1DeciC);
+  put_u16(frame + 164, (uint16_t)info.t2DeciC);
+  // Balance current is sign and magnitude, the high nibble set for negative
+  uint16_t balance = info.balanceMa < 0 ? (0xF000 | (uint16_t)(-info.balanceMa & 0x0FFF)) : (uint16_t)info.balanceMa;
+  put_u16(frame + 170, balance);
+  frame[172] = info.balanceMa != 0 ? (info.balanceMa > 0 ? 1 : 2) : 0;
+  frame[173] = info.soc;
+  put_u32(frame + 174, info.capacityRemainMah);
+  put_u32(frame + 178, info.nominalCapacityMah);
+  put_u32(frame + 182, info.cycleCount);
+  put_u32(frame + 186, info.cycleCount * info.nominalCapacityMah);
+  frame[194] = info.uptimeSeconds;
+  frame[195] = info.uptimeSeconds >> 8;
+  frame[196] = info.uptimeSeconds >> 16;
+  frame[198] = info.charge;
+  frame[199] = info.discharge;
+  frame[201] = info.balance;
+
+  end_frame(frame);
+}
+
+void jk_build_settings(uint8_t *frame, const JkSettings &s, uint8_t counter) {
+  begin_frame(frame, JK_FRAME_SETTINGS, counter);
+  put_u32(frame + 10, s.cellUvpMv);
+  put_u32(frame + 14, s.cellUvpRecoveryMv);
+  put_u32(frame + 18, s.cellOvpMv);
+  put_u32(frame + 22, s.cellOvpRecoveryMv);
+  put_u32(frame + 26, s.balanceTriggerMv);
+  put_u32(frame + 46, s.cellUvpMv - 100);  // Power off voltage
+  put_u32(frame + 50, s.maxChargeMa);
+  put_u32(frame + 54, 30);                 // Charge OCP delay (s)
+  put_u32(frame + 58, 60);                 // Charge OCP recovery (s)
+  put_u32(frame + 62, s.maxDischargeMa);
+  put_u32(frame + 66, 300);                // Discharge OCP delay (s)
+  put_u32(frame + 70, 60);                 // Discharge OCP recovery (s)
+  put_u32(frame + 74, 5);                  // SCP recovery (s)
+  put_u32(frame + 78, 2000);               // Max balance current (mA)
+  put_u32(frame + 82, (uint32_t)s.chargeOtpDeciC);
+  put_u32(frame + 86, (uint32_t)s.chargeOtpRecoveryDeciC);
+  put_u32(frame + 90, (uint32_t)s.dischargeOtpDeciC);
+  put_u32(frame + 94, (uint32_t)s.dischargeOtpRecoveryDeciC);
+  put_u32(frame + 98, (uint32_t)s.chargeUtpDeciC);
+  put_u32(frame + 102, (uint32_t)s.chargeUtpRecoveryDeciC);
+  put_u32(frame + 106, (uint32_t)s.mosOtpDeciC);
+  put_u32(frame + 110, (uint32_t)s.mosOtpRecoveryDeciC);
+  put_u32(frame + 114, s.cellCount);
+  put_u32(frame + 130, s.capacityMah);
+  put_u32(frame + 134, 1500);              // SCP delay (us)
+  put_u32(frame + 138, 3000);              // Balance starting voltage (mV)
+  end_frame(frame);
+}
+
+void jk_build_device_info(uint8_t *frame, const char *name, uint8_t counter) {
+  begin_frame(frame, JK_FRAME_DEVICE_INFO, counter);
+  put_text(frame + 6, "JK_B1A8S10P", 16);
+  put_text(frame + 22, "11.XW", 8);
+  put_text(frame + 30, "11.26", 8);
+  put_u32(frame + 38, 3600);
+  put_u32(frame + 42, 12);
+  put_text(frame + 46, name, 16);
+  put_text(frame + 62, "1234", 16);
+  put_text(frame + 78, "240101", 8);
+  put_text(frame + 86, "SIM00000001", 11);
+  end_frame(frame);
+}
+
+JkSettings jk_default_settings(int cellCount) {
+  JkSettings s = {};
+  s.cellCount = cellCount;
+  s.cellUvpMv = 2800;
+  s.cellUvpRecoveryMv = 3000;
+  s.cellOvpMv = 3650;
+  s.cellOvpRecoveryMv = 3400;
+  s.balanceTriggerMv = 10;
+  s.maxChargeMa = 100000;
+  s.maxDischargeMa = 150000;
+  s.chargeOtpDeciC = 450;
+  s.chargeOtpRecoveryDeciC = 400;
+  s.dischargeOtpDeciC = 600;
+  s.dischargeOtpRecoveryDeciC = 550;
+  s.chargeUtpDeciC = 20;
+  s.chargeUtpRecoveryDeciC = 50;
+  s.mosOtpDeciC = 900;
+  s.mosOtpRecoveryDeciC = 700;
+  s.capacityMah = 280000;
+  return s;
+}
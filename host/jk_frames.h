@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Builders for JK02 response frames as sent by the BMS.
+// Offsets match the decoders in src/bms/jkbms.cpp.
+
+#define JK_FRAME_SETTINGS 0x01
+#define JK_FRAME_CELL_INFO 0x02
+#define JK_FRAME_DEVICE_INFO 0x03
+
+struct JkCellInfo {
+  int cellCount;
+  uint16_t cellMv[16];
+  uint16_t wireResistMohm[16];
+  int32_t packMv;
+  int32_t currentMa;  // Positive while charging
+  int16_t mosDeciC;
+  int16_t t1DeciC;
+  int16_t t2DeciC;
+  int16_t balanceMa;
+  uint8_t soc;
+  uint32_t capacityRemainMah;
+  uint32_t nominalCapacityMah;
+  uint32_t cycleCount;
+  uint32_t uptimeSeconds;
+  bool charge;
+  bool discharge;
+  bool balance;
+};
+
+struct JkSettings {
+  int cellCount;
+  uint32_t cellUvpMv;
+  uint32_t cellUvpRecoveryMv;
+  uint32_t cellOvpMv;
+  uint32_t cellOvpRecoveryMv;
+  uint32_t balanceTriggerMv;
+  uint32_t maxChargeMa;
+  uint32_t maxDischargeMa;
+  int32_t chargeOtpDeciC;
+  int32_t chargeOtpRecoveryDeciC;
+  int32_t dischargeOtpDeciC;
+  int32_t dischargeOtpRecoveryDeciC;
+  int32_t chargeUtpDeciC;
+  int32_t chargeUtpRecoveryDeciC;
+  int32_t mosOtpDeciC;
+  int32_t mosOtpRecoveryDeciC;
+  uint32_t capacityMah;
+};
+
+// Each builder fills a JK_FRAME_SIZE buffer, including header and checksum
+void jk_build_cell_info(uint8_t *frame, const JkCellInfo &info, uint8_t counter);
+void jk_build_settings(uint8_t *frame, const JkSettings &settings, uint8_t counter);
+void jk_build_device_info(uint8_t *frame, const char *name, uint8_t counter);
+
+// Typical 16s LiFePO4 values
+JkSettings jk_default_settings(int cellCount);
@@ -0,0 +1,131 @@
+// Runs the JKBMS connect -> init -> stream sequence against MockTransport
+// and reports how long the receive path takes per notification.
+//
+//   pio run -e native && .pio/build/native/program [packs] [frames] [mtu]
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include "jk_frames.h"
+#include "../src/bms/jkbms.h"
+#include "../src/bms/registry.h"
+#include "../src/bms/mock_transport.h"
+#include "../src/bms/telemetry.h"
+#include "../src/bms/alarms.h"
+
+// Answers init commands the way a JK BMS does
+static void answer_command(MockTransport *transport, const uint8_t *data, size_t length, void *context) {
+  uint8_t frame[JK_FRAME_SIZE];
+  switch (data[4]) {
+    case 0x97:
+      jk_build_device_info(frame, "MOCK-BMS", 0);
+      transport->notify(frame, sizeof(frame));
+      break;
+    case 0x96:
+      jk_build_settings(frame, jk_default_settings(16), 0);
+      transport->notify(frame, sizeof(frame));
+      break;
+  }
+}
+
+static bool check(bool ok, const char *what, int slot) {
+  if (!ok) fprintf(stderr, "FAIL slot %d: %s\n", slot, what);
+  return ok;
+}
+
+int main(int argc, char **argv) {
+  int packs = argc > 1 ? atoi(argv[1]) : 2;
+  int frames = argc > 2 ? atoi(argv[2]) : 1000;
+  int mtu = argc > 3 ? atoi(argv[3]) : 23;
+  if (packs < 1 || packs > BMS_MAX_DEVICES) packs = 1;
+
+  Serial.enabled = getenv("JKBMS_VERBOSE") != nullptr;
+  bmsRegistry.setTransportProvider(mockTransportForSlot);
+  telemetry_enable(TELEMETRY_UI, true);
+
+  bool ok = true;
+  for (int i = 0; i < packs; i++) {
+    char mac[18];
+    snprintf(mac, sizeof(mac), "00:00:00:00:00:%02x", i);
+    JKBMS *bms = bmsRegistry.add(mac);
+    MockTransport *transport = mockTransportFor(i);
+    transport->mtuValue = mtu;
+    transport->onWrite(answer_command, nullptr);
+
+    ok &= check(bms->connectToServer(), "connectToServer", i);
+    ok &= check(bms->connected && transport->isSubscribed(), "connected and subscribed", i);
+    ok &= check(transport->lastCommand() == 0x96, "cell info requested last", i);
+    ok &= check(bms->cell_count == 16, "settings frame parsed", i);
+    ok &= check(bms->negotiatedMTU == mtu, "MTU reported", i);
+  }
+
+  // Stream cell frames to every pack
+  JkCellInfo info = {};
+  info.cellCount = 16;
+  info.packMv = 53120;
+  info.currentMa = -12500;
+  info.soc = 80;
+  for (int c = 0; c < 16; c++) info.cellMv[c] = 3320 + c;
+
+  uint8_t frame[JK_FRAME_SIZE];
+  unsigned long notifications = 0;
+  unsigned long start = micros();
+  for (int f = 0; f < frames; f++) {
+    info.cellMv[0] = 3300 + (f % 50);
+    jk_build_cell_info(frame, info, f);
+    for (int i = 0; i < packs; i++) {
+      mockTransportFor(i)->notify(frame, sizeof(frame));
+      notifications += (sizeof(frame) + mtu - 4) / (mtu - 3);
+    }
+  }
+  unsigned long elapsed = micros() - start;
+
+  for (int i = 0; i < packs; i++) {
+    JKBMS *bms = bmsRegistry.get(i);
+    ok &= check(bms->firstReadingTime != 0, "cell frame parsed", i);
+    ok &= check(bms->Battery_Voltage > 53.0f && bms->Battery_Voltage < 53.2f, "pack voltage decoded", i);
+
+    // Nothing drained while streaming, so the ring kept the first samples and counted the rest
+    TelemetrySample sample = {};
+    uint32_t popped = 0;
+    while (telemetry_pop(TELEMETRY_UI, i, sample)) popped++;
+    ok &= check(popped == TELEMETRY_QUEUE_DEPTH && sample.seq == popped, "samples queued in order", i);
+    ok &= check(sample.packMv == (uint32_t)info.packMv && sample.currentMa == info.currentMa && sample.cellMv[1] == 3321, "sample decoded", i);
+    printf("pack %d: MTU %u, %u notifications/frame\n", i, bms->negotiatedMTU, bms->lastFrameNotifyCount);
+  }
+
+  // Alarms: nothing near the limits while streaming, then cell 5 crosses the
+  // warning level below OVP and has to come back past the hysteresis to clear
+  int32_t highSet = jk_default_settings(16).cellOvpMv - ALARM_CELL_MARGIN_MV;
+  const int32_t steps[] = { highSet, highSet - ALARM_CELL_HYST_MV + 1, highSet - ALARM_CELL_HYST_MV - 1 };
+  const bool expected[] = { true, true, false };
+  for (int i = 0; i < packs; i++) {
+    ok &= check(alarms_active(i) == 0, "no alarms while streaming", i);
+    alarms_take_changed(i);
+  }
+  for (int step = 0; step < 3; step++) {
+    info.cellMv[4] = steps[step];
+    jk_build_cell_info(frame, info, frames + step);
+    mockTransportFor(0)->notify(frame, sizeof(frame));
+    bool raised = alarms_active(0) & ALARM_BIT(ALARM_CELL_HIGH);
+    ok &= check(raised == expected[step], "cell high alarm with hysteresis", 0);
+    ok &= check(alarms_take_changed(0) == (step != 1), "alarm change flagged once", 0);
+    ok &= check(alarms_high_cell(0) == (expected[step] ? 5 : 0), "alarm cell reported", 0);
+  }
+
+  // Before any settings frame the cell count comes from the cell frame,
+  // so the delta rule already runs
+  int fresh = BMS_MAX_DEVICES - 1;
+  for (int c = 0; c < 16; c++) info.cellMv[c] = 3320 + c;
+  info.cellMv[4] = 3320 + ALARM_DELTA_MV + 20;
+  jk_build_cell_info(frame, info, 0);
+  TelemetrySample early = {};
+  telemetry_sample_from_frame(frame, 0, early);
+  ok &= check(early.cellCount == 16, "cell count from the cell frame", fresh);
+  ok &= check(alarms_evaluate(fresh, early) == ALARM_BIT(ALARM_CELL_DELTA), "delta alarm before settings", fresh);
+
+  printf("telemetry: %lu samples dropped by the undrained UI consumer\n", (unsigned long)telemetry_overflows(TELEMETRY_UI));
+  printf("%d packs x %d frames, %lu notifications in %lu us (%.3f us/notification)\n",
+         packs, frames, notifications, elapsed, notifications ? (double)elapsed / notifications : 0.0);
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+#include "jk_sim.h"
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+#include <Arduino.h>
+#include "../../src/bms/jkbms.h"
+#include "../../src/bms/mock_transport.h"
+
+// ATT notification header size
+#define ATT_NOTIFY_OVERHEAD 3
+
+// LiFePO4 open circuit voltage against state of charge
+static const float OCV_SOC[] = { 0.0f, 0.05f, 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 0.7f, 0.8f, 0.9f, 0.95f, 1.0f };
+static const float OCV_MV[] = { 2800, 3000, 3200, 3250, 3275, 3290, 3300, 3310, 3320, 3330, 3345, 3380, 3550 };
+static const int OCV_POINTS = sizeof(OCV_SOC) / sizeof(OCV_SOC[0]);
+
+// Internal resistance per cell, milliohm
+static const float CELL_RESISTANCE_MOHM = 0.25f;
+
+static float ocv_mv(float soc) {
+  if (soc <= OCV_SOC[0]) return OCV_MV[0];
+  for (int i = 1; i < OCV_POINTS; i++) {
+    if (soc <= OCV_SOC[i]) {
+      float t = (soc - OCV_SOC[i - 1]) / (OCV_SOC[i] - OCV_SOC[i - 1]);
+      return OCV_MV[i - 1] + t * (OCV_MV[i] - OCV_MV[i - 1]);
+    }
+  }
+  return OCV_MV[OCV_POINTS - 1];
+}
+
+uint32_t SimRandom::next() {
+  // xorshift32
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+
+float SimRandom::uniform() {
+  return (next() >> 8) * (1.0f / 16777216.0f);
+}
+
+float SimRandom::gaussian() {
+  // Box-Muller, one value per call is enough here
+  float u1 = uniform();
+  float u2 = uniform();
+  if (u1 < 1e-7f) u1 = 1e-7f;
+  return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+void SimPack::begin(const SimPackConfig &config, uint32_t seed) {
+  cfg = config;
+  if (cfg.cellCount < 1) cfg.cellCount = 1;
+  if (cfg.cellCount > 16) cfg.cellCount = 16;
+  rng = SimRandom(seed);
+  soc = cfg.startSoc;
+  timeS = 0;
+  for (int i = 0; i < cfg.cellCount; i++) {
+    cellOffsetMv[i] = (rng.uniform() - 0.5f) * cfg.cellMismatchMv;
+  }
+
+  info = {};
+  info.cellCount = cfg.cellCount;
+  info.nominalCapacityMah = cfg.capacityAh * 1000;
+  info.cycleCount = 42;
+  info.charge = true;
+  info.discharge = true;
+  for (int i = 0; i < 16; i++) info.wireResistMohm[i] = 30 + (rng.next() % 40);
+  step(0);
+}
+
+float SimPack::currentAt(float t) {
+  switch (cfg.profile) {
+    case SIM_CHARGE:
+      return cfg.currentA;
+    case SIM_DISCHARGE:
+      return -cfg.currentA;
+    case SIM_CYCLE:
+      return fmodf(t, 2 * cfg.cyclePeriodS) < cfg.cyclePeriodS ? cfg.currentA : -cfg.currentA;
+    case SIM_INVERTER:
+      // Base load plus motor-start style spikes that decay
+      if (rng.uniform() < 0.02f) transientA = cfg.currentA * (1.0f + 2.0f * rng.uniform());
+      transientA *= 0.8f;
+      return -(cfg.currentA * 0.3f + transientA);
+    case SIM_IDLE:
+    default:
+      return 0;
+  }
+}
+
+void SimPack::step(float dtS) {
+  timeS += dtS;
+  float currentA = currentAt(timeS);
+
+  soc += currentA * dtS / 3600.0f / cfg.capacityAh;
+  if (soc < 0) soc = 0;
+  if (soc > 1) soc = 1;
+
+  // Slow first order heating from I^2 R
+  float targetC = 25.0f + fabsf(currentA) * 0.1f;
+  tempC += (targetC - tempC) * (dtS / 300.0f > 1 ? 1 : dtS / 300.0f);
+
+  float baseMv = ocv_mv(soc) + currentA * CELL_RESISTANCE_MOHM;
+  int32_t packMv = 0;
+  uint16_t hi = 0;
+  for (int i = 0; i < cfg.cellCount; i++) {
+    float mv = baseMv + cellOffsetMv[i] + rng.gaussian() * cfg.noiseMv;
+    info.cellMv[i] = (uint16_t)lroundf(mv);
+    packMv += info.cellMv[i];
+    if (info.cellMv[i] > hi) hi = info.cellMv[i];
+  }
+
+  info.packMv = packMv;
+  info.currentMa = (int32_t)lroundf(currentA * 1000.0f + rng.gaussian() * 50.0f);
+  info.soc = (uint8_t)lroundf(soc * 100.0f);
+  info.capacityRemainMah = (uint32_t)(soc * cfg.capacityAh * 1000.0f);
+  info.t1DeciC = (int16_t)lroundf(tempC * 10.0f);
+  info.t2DeciC = (int16_t)lroundf(tempC * 10.0f - 5.0f);
+  info.mosDeciC = (int16_t)lroundf(tempC * 10.0f + 30.0f);
+  info.uptimeSeconds = 86400 + (uint32_t)timeS;
+  info.balance = currentA > 0 && soc > 0.9f;
+  info.balanceMa = info.balance ? 600 : 0;
+}
+
+JkSettings SimPack::settings() const {
+  JkSettings s = jk_default_settings(cfg.cellCount);
+  s.capacityMah = cfg.capacityAh * 1000;
+  return s;
+}
+
+void SimLink::begin(MockTransport *linkTransport, SimPack *simPack, const SimLinkConfig &config, uint32_t seed) {
+  transport = linkTransport;
+  pack = simPack;
+  cfg = config;
+  rng = SimRandom(seed);
+  transport->mtuValue = cfg.mtu;
+  transport->onWrite(onWrite, this);
+}
+
+// Answers init commands the way a JK BMS does
+void SimLink::onWrite(MockTransport *transport, const uint8_t *data, size_t length, void *context) {
+  SimLink *link = static_cast<SimLink *>(context);
+  uint8_t frame[JK_FRAME_SIZE];
+  switch (data[4]) {
+    case 0x97:
+      jk_build_device_info(frame, "SIM-BMS", link->counter++);
+      link->sendFrame(frame);
+      break;
+    case 0x96:
+      jk_build_settings(frame, link->pack->settings(), link->counter++);
+      link->sendFrame(frame);
+      break;
+  }
+}
+
+float SimLink::sendCellFrame() {
+  uint8_t frame[JK_FRAME_SIZE];
+  linkMs = 0;
+
+  if (cfg.settingsEvery > 0 && counters.framesSent > 0 && counters.framesSent % cfg.settingsEvery == 0) {
+    jk_build_settings(frame, pack->settings(), counter++);
+    sendFrame(frame);
+  }
+
+  jk_build_cell_info(frame, pack->cellInfo(), counter++);
+  sendFrame(frame);
+  counters.framesSent++;
+  return linkMs;
+}
+
+void SimLink::sendFrame(uint8_t *frame) {
+  int maxChunk = cfg.mtu - ATT_NOTIFY_OVERHEAD;
+  if (cfg.chunkSize > 0 && cfg.chunkSize < maxChunk) maxChunk = cfg.chunkSize;
+
+  // Pick one corruption for this frame
+  int dropChunk = -1;
+  if (cfg.corruptRate > 0 && rng.uniform() < cfg.corruptRate) {
+    counters.corrupted++;
+    switch (rng.next() % 3) {
+      case 0:  // Bit flip somewhere in the payload, caught by the checksum
+        frame[6 + rng.next() % (JK_FRAME_SIZE - 7)] ^= 1 << (rng.next() % 8);
+        break;
+      case 1:  // Lost notification, the frame never completes
+        dropChunk = 1 + rng.next() % 4;
+        break;
+      default:  // Damaged header, the whole frame is ignored
+        frame[1] ^= 0xFF;
+        break;
+    }
+  }
+
+  int index = 0;
+  for (int offset = 0; offset < JK_FRAME_SIZE; index++) {
+    int n = maxChunk;
+    if (cfg.chunkSize < 0) n = 1 + rng.next() % maxChunk;
+    if (n > JK_FRAME_SIZE - offset) n = JK_FRAME_SIZE - offset;
+    if (index != dropChunk) deliver(frame + offset, n);
+    offset += n;
+  }
+}
+
+void SimLink::deliver(const uint8_t *data, size_t length) {
+  // Connection events are 7.5 ms apart at the 12 unit interval used by NimBleTransport
+  float gapMs = 7.5f + cfg.jitterMs * rng.uniform();
+  linkMs += gapMs;
+
+  unsigned long start = micros();
+  transport->notifyChunk(data, length);
+  counters.receiveMicros += micros() - start;
+  counters.notifications++;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../jk_frames.h"
+
+class MockTransport;
+
+// Load profile of a simulated pack
+enum SimProfile {
+  SIM_IDLE,
+  SIM_CHARGE,
+  SIM_DISCHARGE,
+  SIM_CYCLE,     // Alternates charge and discharge every cyclePeriodS
+  SIM_INVERTER   // Discharge base load with random transients
+};
+
+struct SimPackConfig {
+  int cellCount = 16;
+  float capacityAh = 280.0f;
+  float startSoc = 0.6f;
+  float currentA = 40.0f;        // Magnitude used by the profiles
+  float cellMismatchMv = 8.0f;   // Spread of per-cell OCV offsets
+  float noiseMv = 2.0f;          // Per-frame measurement noise
+  SimProfile profile = SIM_CYCLE;
+  float cyclePeriodS = 600.0f;
+};
+
+struct SimLinkConfig {
+  uint16_t mtu = 23;
+  int chunkSize = 0;             // 0 = MTU - 3, <0 = random sizes up to MTU - 3
+  float jitterMs = 0.0f;         // Random extra gap between notifications
+  float corruptRate = 0.0f;      // Probability that a frame gets corrupted
+  int settingsEvery = 0;         // Resend the settings frame every N cell frames, 0 = never
+};
+
+// Counters for one pack's link
+struct SimStats {
+  uint32_t framesSent = 0;
+  uint32_t notifications = 0;
+  uint32_t corrupted = 0;
+  uint64_t receiveMicros = 0;    // Time spent inside the JKBMS receive path
+};
+
+// Small deterministic PRNG so runs are reproducible from a seed
+class SimRandom {
+public:
+  explicit SimRandom(uint32_t seed = 1) : state(seed ? seed : 1) {}
+  uint32_t next();
+  float uniform();               // [0, 1)
+  float gaussian();              // Mean 0, sd 1
+private:
+  uint32_t state;
+};
+
+// Electrical model of one JK pack. step() advances it and produces the
+// next cell info frame content.
+class SimPack {
+public:
+  void begin(const SimPackConfig &config, uint32_t seed);
+  void step(float dtS);
+  const JkCellInfo &cellInfo() const { return info; }
+  JkSettings settings() const;
+
+private:
+  float currentAt(float timeS);
+
+  SimPackConfig cfg;
+  SimRandom rng;
+  JkCellInfo info = {};
+  float soc = 0;
+  float timeS = 0;
+  float tempC = 25.0f;
+  float transientA = 0;
+  float cellOffsetMv[16] = { 0 };
+};
+
+// Feeds one simulated pack into a MockTransport: answers the init commands,
+// then emits chunked cell frames with jitter and injected corruption.
+class SimLink {
+public:
+  void begin(MockTransport *transport, SimPack *pack, const SimLinkConfig &config, uint32_t seed);
+  // Send the next cell frame, returns the simulated link time it took in ms
+  float sendCellFrame();
+  const SimStats &stats() const { return counters; }
+
+private:
+  static void onWrite(MockTransport *transport, const uint8_t *data, size_t length, void *context);
+  void sendFrame(uint8_t *frame);
+  void deliver(const uint8_t *data, size_t length);
+
+  MockTransport *transport = nullptr;
+  SimPack *pack = nullptr;
+  SimLinkConfig cfg;
+  SimRandom rng;
+  SimStats counters;
+  uint8_t counter = 0;
+  float linkMs = 0;
+};
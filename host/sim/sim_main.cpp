@@ -0,0 +1,165 @@
+// Host-side JK BMS traffic simulator.
+// Generates JK02 notification streams for several simulated packs and pushes
+// them through the real JKBMS receive path via MockTransport.
+//
+//   pio run -e native_sim && .pio/build/native_sim/program --packs 8 --rate 0
+//
+// --rate 0 runs as fast as possible and reports the throughput ceiling,
+// any other rate paces frames in real time.
+
+#include <Arduino.h>
+#include <getopt.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "jk_sim.h"
+#include "../../src/bms/jkbms.h"
+#include "../../src/bms/registry.h"
+#include "../../src/bms/mock_transport.h"
+
+struct SimOptions {
+  int packs = 1;
+  float rate = 0;          // Cell frames per second per pack, 0 = unpaced
+  float duration = 60;     // Simulated seconds
+  uint32_t seed = 1;
+  bool verbose = false;
+  SimPackConfig pack;
+  SimLinkConfig link;
+};
+
+static void usage() {
+  printf(
+    "Usage: program [options]\n"
+    "  --packs N         simulated packs (1-%d)\n"
+    "  --cells N         cells per pack (1-16)\n"
+    "  --rate HZ         cell frames per second per pack, 0 = as fast as possible\n"
+    "  --duration S      simulated seconds\n"
+    "  --profile P       idle|charge|discharge|cycle|inverter\n"
+    "  --current A       profile current magnitude\n"
+    "  --noise MV        cell measurement noise\n"
+    "  --mtu N           negotiated ATT MTU\n"
+    "  --chunk N         notification payload size, -1 = random\n"
+    "  --jitter MS       random extra gap between notifications\n"
+    "  --corrupt P       probability a frame is corrupted (0-1)\n"
+    "  --settings-every N  resend settings every N cell frames\n"
+    "  --seed N          PRNG seed\n"
+    "  --verbose         keep the firmware debug output\n",
+    BMS_MAX_DEVICES);
+}
+
+static SimProfile parse_profile(const char *name) {
+  if (!strcmp(name, "idle")) return SIM_IDLE;
+  if (!strcmp(name, "charge")) return SIM_CHARGE;
+  if (!strcmp(name, "discharge")) return SIM_DISCHARGE;
+  if (!strcmp(name, "inverter")) return SIM_INVERTER;
+  return SIM_CYCLE;
+}
+
+static bool parse_options(int argc, char **argv, SimOptions &o) {
+  static const option longOptions[] = {
+    { "packs", required_argument, nullptr, 'p' },
+    { "cells", required_argument, nullptr, 'c' },
+    { "rate", required_argument, nullptr, 'r' },
+    { "duration", required_argument, nullptr, 'd' },
+    { "profile", required_argument, nullptr, 'P' },
+    { "current", required_argument, nullptr, 'a' },
+    { "noise", required_argument, nullptr, 'n' },
+    { "mtu", required_argument, nullptr, 'm' },
+    { "chunk", required_argument, nullptr, 'k' },
+    { "jitter", required_argument, nullptr, 'j' },
+    { "corrupt", required_argument, nullptr, 'x' },
+    { "settings-every", required_argument, nullptr, 's' },
+    { "seed", required_argument, nullptr, 'S' },
+    { "verbose", no_argument, nullptr, 'v' },
+    { "help", no_argument, nullptr, 'h' },
+    { nullptr, 0, nullptr, 0 }
+  };
+
+  int c;
+  while ((c = getopt_long(argc, argv, "", longOptions, nullptr)) != -1) {
+    switch (c) {
+      case 'p': o.packs = atoi(optarg); break;
+      case 'c': o.pack.cellCount = atoi(optarg); break;
+      case 'r': o.rate = atof(optarg); break;
+      case 'd': o.duration = atof(optarg); break;
+      case 'P': o.pack.profile = parse_profile(optarg); break;
+      case 'a': o.pack.currentA = atof(optarg); break;
+      case 'n': o.pack.noiseMv = atof(optarg); break;
+      case 'm': o.link.mtu = atoi(optarg); break;
+      case 'k': o.link.chunkSize = atoi(optarg); break;
+      case 'j': o.link.jitterMs = atof(optarg); break;
+      case 'x': o.link.corruptRate = atof(optarg); break;
+      case 's': o.link.settingsEvery = atoi(optarg); break;
+      case 'S': o.seed = strtoul(optarg, nullptr, 0); break;
+      case 'v': o.verbose = true; break;
+      default: usage(); return false;
+    }
+  }
+  if (o.packs < 1 || o.packs > BMS_MAX_DEVICES) o.packs = BMS_MAX_DEVICES;
+  if (o.link.mtu < 23) o.link.mtu = 23;
+  return true;
+}
+
+int main(int argc, char **argv) {
+  SimOptions o;
+  if (!parse_options(argc, argv, o)) return 2;
+
+  Serial.enabled = o.verbose;
+  bmsRegistry.setTransportProvider(mockTransportForSlot);
+
+  static SimPack packs[BMS_MAX_DEVICES];
+  static SimLink links[BMS_MAX_DEVICES];
+
+  for (int i = 0; i < o.packs; i++) {
+    char mac[24];
+    snprintf(mac, sizeof(mac), "5a:5a:00:00:00:%02x", i);
+    JKBMS *bms = bmsRegistry.add(mac);
+    packs[i].begin(o.pack, o.seed + i * 7919);
+    links[i].begin(mockTransportFor(i), &packs[i], o.link, o.seed + i * 104729);
+    if (!bms->connectToServer()) {
+      fprintf(stderr, "pack %d: connect failed\n", i);
+      return 1;
+    }
+  }
+
+  // Frames are generated on a simulated clock; with a rate set we also
+  // sleep so the receive path sees them in real time
+  float frameDtS = o.rate > 0 ? 1.0f / o.rate : 1.0f;
+  int frameCount = (int)(o.duration / frameDtS);
+  float maxLinkMs = 0;
+  unsigned long wallStart = micros();
+
+  for (int f = 0; f < frameCount; f++) {
+    for (int i = 0; i < o.packs; i++) {
+      packs[i].step(frameDtS);
+      float linkMs = links[i].sendCellFrame();
+      if (linkMs > maxLinkMs) maxLinkMs = linkMs;
+    }
+    if (o.rate > 0) {
+      long due = wallStart + (long)((f + 1) * frameDtS * 1e6f);
+      long wait = due - (long)micros();
+      if (wait > 0) usleep(wait);
+    }
+  }
+  unsigned long wallMicros = micros() - wallStart;
+
+  printf("%-4s %8s %8s %8s %8s %10s %10s %10s\n", "pack", "sent", "parsed", "crc_err", "corrupt", "notif/frm", "us/notif", "us/frame");
+  uint64_t totalReceiveMicros = 0;
+  uint32_t totalFrames = 0;
+  for (int i = 0; i < o.packs; i++) {
+    JKBMS *bms = bmsRegistry.get(i);
+    const SimStats &st = links[i].stats();
+    totalReceiveMicros += st.receiveMicros;
+    totalFrames += st.framesSent;
+    printf("%-4d %8u %8u %8u %8u %10u %10.3f %10.3f\n", i, st.framesSent, bms->framesReceived, bms->crcErrors, st.corrupted,
+           bms->lastFrameNotifyCount,
+           st.notifications ? (double)st.receiveMicros / st.notifications : 0.0,
+           st.framesSent ? (double)st.receiveMicros / st.framesSent : 0.0);
+  }
+
+  double ceiling = totalReceiveMicros ? totalFrames * 1e6 / totalReceiveMicros : 0;
+  printf("\n%u frames in %.3f s wall, receive path busy %.3f ms\n", totalFrames, wallMicros / 1e6, totalReceiveMicros / 1e3);
+  printf("receive path ceiling: %.0f frames/s across all packs\n", ceiling);
+  printf("link time per frame: max %.1f ms%s\n", maxLinkMs,
+         o.rate > 0 && maxLinkMs > frameDtS * 1000 ? " (link saturated at this rate)" : "");
+  return 0;
+}
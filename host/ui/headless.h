@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+// Headless display for the host UI build. Implements src/ui/display.h on
+// an in-memory RGB565 framebuffer instead of the TFT and touch controller.
+
+// Framebuffer in the current display orientation
+const uint16_t *headless_framebuffer(int &width, int &height);
+
+// PNG encoding of an RGB565 image. Uses uncompressed deflate blocks so the
+// output only depends on the pixels, which makes byte-wise golden checks work.
+std::vector<uint8_t> png_encode_rgb565(const uint16_t *pixels, int width, int height);
+bool png_write_file(const char *path, const std::vector<uint8_t> &png);
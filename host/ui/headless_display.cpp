@@ -0,0 +1,129 @@
+#include <Arduino.h>
+#include <lvgl.h>
+#include "User_Setup.h"
+#include "headless.h"
+#include "../../src/ui/display.h"
+#include "../../src/tasks/tasks.h"
+#include "../../src/utils/utils.h"
+
+static uint16_t framebuffer[TFT_WIDTH * TFT_HEIGHT];
+// One full screen partial buffer, so every refresh is a single flush per area
+static uint8_t drawBuf[TFT_WIDTH * TFT_HEIGHT * sizeof(uint16_t)];
+
+static DisplayFlushStats flushStats = {};
+static TouchStats touchStats = {};
+static uint32_t refreshStartUs = 0;
+
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
+  uint32_t start = micros();
+  int32_t stride = lv_display_get_horizontal_resolution(disp);
+  int32_t w = lv_area_get_width(area);
+  const uint16_t *src = (const uint16_t *)px_map;
+  for (int32_t y = area->y1; y <= area->y2; y++) {
+    memcpy(&framebuffer[y * stride + area->x1], src, w * sizeof(uint16_t));
+    src += w;
+  }
+  flushStats.flushes++;
+  flushStats.bytes += w * lv_area_get_height(area) * sizeof(uint16_t);
+  flushStats.flushUs += micros() - start;
+  lv_display_flush_ready(disp);
+}
+
+static void refresh_start_cb(lv_event_t *e) {
+  refreshStartUs = micros();
+}
+
+static void refresh_done_cb(lv_event_t *e) {
+  uint32_t us = micros() - refreshStartUs;
+  flushStats.refreshes++;
+  flushStats.refreshUs += us;
+  if (us > flushStats.maxRefreshUs) flushStats.maxRefreshUs = us;
+}
+
+// Nothing touches a headless panel
+static void touch_read_cb(lv_indev_t *indev, lv_indev_data_t *data) {
+  data->state = LV_INDEV_STATE_RELEASED;
+}
+
+lv_display_t *display_init(lv_display_rotation_t rotation) {
+  lv_init();
+  lv_tick_set_cb([]() -> uint32_t { return millis(); });
+
+  lv_display_t *disp = lv_display_create(TFT_WIDTH, TFT_HEIGHT);
+  lv_display_set_flush_cb(disp, flush_cb);
+  lv_display_set_buffers(disp, drawBuf, NULL, sizeof(drawBuf), LV_DISPLAY_RENDER_MODE_PARTIAL);
+  lv_display_add_event_cb(disp, refresh_start_cb, LV_EVENT_REFR_START, NULL);
+  lv_display_add_event_cb(disp, refresh_done_cb, LV_EVENT_REFR_READY, NULL);
+  lv_display_set_rotation(disp, rotation);
+
+  lv_indev_t *indev = lv_indev_create();
+  lv_indev_set_type(indev, LV_INDEV_TYPE_POINTER);
+  lv_indev_set_read_cb(indev, touch_read_cb);
+  lv_indev_set_mode(indev, LV_INDEV_MODE_EVENT);
+  return disp;
+}
+
+void display_backlight(uint8_t level) {}
+
+int display_light_level() {
+  return -1;
+}
+
+uint32_t display_touch_service() {
+  return UINT32_MAX;
+}
+
+bool display_touch_pending() {
+  return false;
+}
+
+void display_touch_swallow() {}
+
+const TouchStats &display_touch_stats() {
+  return touchStats;
+}
+
+const DisplayFlushStats &display_flush_stats() {
+  return flushStats;
+}
+
+void display_reset_flush_stats() {
+  flushStats = {};
+}
+
+void display_benchmark(int frames) {
+  lv_display_t *disp = lv_display_get_default();
+  uint32_t start = micros();
+  for (int i = 0; i < frames; i++) {
+    lv_obj_invalidate(lv_screen_active());
+    lv_refr_now(disp);
+  }
+  uint32_t elapsed = micros() - start;
+  printf("Display benchmark (headless): %d frames in %lu us, %.1f fps\n", frames, (unsigned long)elapsed,
+         elapsed ? frames * 1000000.0 / elapsed : 0.0);
+}
+
+const uint16_t *headless_framebuffer(int &width, int &height) {
+  lv_display_t *disp = lv_display_get_default();
+  width = lv_display_get_horizontal_resolution(disp);
+  height = lv_display_get_vertical_resolution(disp);
+  return framebuffer;
+}
+
+// The task layer of src/tasks/tasks.cpp and the heap monitor of
+// src/utils/utils.cpp, as far as the UI code calls into them
+static TaskStats hostTaskStats[TASK_COUNT] = { { "bms" }, { "ui" } };
+uint32_t minFreeHeap = 0;
+
+const TaskStats &task_stats(TaskId id) {
+  return hostTaskStats[id];
+}
+
+void monitorFreeHeap() {}
+
+bool bms_post_command(BmsCmdType type, const char *mac) {
+  Serial.printf("BMS command %d %s\n", type, mac ? mac : "");
+  return true;
+}
+
+void ui_wake() {}
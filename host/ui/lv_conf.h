@@ -0,0 +1,18 @@
+/**
+ * @file lv_conf.h
+ * LVGL configuration for the headless host build, see host/ui/ui_main.cpp
+ *
+ * Same settings as the CYD (configs/cyd/lv_conf.h), except that LVGL uses
+ * its builtin LV_MEM_SIZE pool so memory numbers are repeatable, and no
+ * display driver library is built.
+ */
+
+/* clang-format off */
+#include "../../configs/cyd/lv_conf.h"
+
+#undef LV_USE_STDLIB_MALLOC
+#define LV_USE_STDLIB_MALLOC    LV_STDLIB_BUILTIN
+#define LV_MEM_SIZE (64 * 1024U)
+
+#undef LV_USE_TFT_ESPI
+#define LV_USE_TFT_ESPI         0
@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include "headless.h"
+
+static uint32_t crcTable[256];
+
+static uint32_t crc32(const uint8_t *data, size_t length, uint32_t crc = 0) {
+  if (!crcTable[1]) {
+    for (uint32_t n = 0; n < 256; n++) {
+      uint32_t c = n;
+      for (int k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+      crcTable[n] = c;
+    }
+  }
+  crc = ~crc;
+  for (size_t i = 0; i < length; i++) crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+static void put_u32(std::vector<uint8_t> &out, uint32_t v) {
+  out.push_back(v >> 24);
+  out.push_back(v >> 16);
+  out.push_back(v >> 8);
+  out.push_back(v);
+}
+
+static void put_chunk(std::vector<uint8_t> &out, const char *type, const std::vector<uint8_t> &data) {
+  put_u32(out, data.size());
+  size_t start = out.size();
+  out.insert(out.end(), type, type + 4);
+  out.insert(out.end(), data.begin(), data.end());
+  put_u32(out, crc32(&out[start], out.size() - start));
+}
+
+std::vector<uint8_t> png_encode_rgb565(const uint16_t *pixels, int width, int height) {
+  // Filter type 0 per row, then RGB888
+  std::vector<uint8_t> raw;
+  raw.reserve((size_t)height * (width * 3 + 1));
+  for (int y = 0; y < height; y++) {
+    raw.push_back(0);
+    for (int x = 0; x < width; x++) {
+      uint16_t c = pixels[y * width + x];
+      raw.push_back(((c >> 11) & 0x1F) * 255 / 31);
+      raw.push_back(((c >> 5) & 0x3F) * 255 / 63);
+      raw.push_back((c & 0x1F) * 255 / 31);
+    }
+  }
+
+  // zlib stream of stored deflate blocks
+  std::vector<uint8_t> z = { 0x78, 0x01 };
+  size_t pos = 0;
+  do {
+    size_t n = raw.size() - pos < 65535 ? raw.size() - pos : 65535;
+    z.push_back(pos + n == raw.size() ? 1 : 0);
+    z.push_back(n & 0xFF);
+    z.push_back(n >> 8);
+    z.push_back(~n & 0xFF);
+    z.push_back((~n >> 8) & 0xFF);
+    z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + n);
+    pos += n;
+  } while (pos < raw.size());
+  uint32_t a = 1, b = 0;
+  for (uint8_t byte : raw) {
+    a = (a + byte) % 65521;
+    b = (b + a) % 65521;
+  }
+  put_u32(z, (b << 16) | a);
+
+  std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+  std::vector<uint8_t> ihdr;
+  put_u32(ihdr, width);
+  put_u32(ihdr, height);
+  ihdr.insert(ihdr.end(), { 8, 2, 0, 0, 0 });  // 8 bit RGB, no interlace
+  put_chunk(png, "IHDR", ihdr);
+  put_chunk(png, "IDAT", z);
+  put_chunk(png, "IEND", {});
+  return png;
+}
+
+bool png_write_file(const char *path, const std::vector<uint8_t> &png) {
+  FILE *f = fopen(path, "wb");
+  if (!f) return false;
+  bool ok = fwrite(png.data(), 1, png.size(), f) == png.size();
+  return fclose(f) == 0 && ok;
+}
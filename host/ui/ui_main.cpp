@@ -0,0 +1,244 @@
+// Headless UI build: runs src/ui against LVGL with an in-memory framebuffer,
+// fed by mock BMS packs, and reports what each screen costs to build,
+// update and render. Every screen can be dumped to PNG and compared with
+// a set of golden images.
+//
+//   pio run -e native_ui && .pio/build/native_ui/program [options]
+//     --packs N        simulated packs (default 2)
+//     --iterations N   data updates timed per screen (default 50)
+//     --out DIR        write <screen>.png for every screen
+//     --golden DIR     compare every screen with DIR/<screen>.png, exit 1 on a mismatch
+//     --prebuild       let the idle-time prebuilder run first, as after boot on the device
+
+#include <Arduino.h>
+#include <lvgl.h>
+#include <stdlib.h>
+#include <vector>
+#include "headless.h"
+#include "../jk_frames.h"
+#include "../../src/bms/jkbms.h"
+#include "../../src/bms/registry.h"
+#include "../../src/bms/mock_transport.h"
+#include "../../src/bms/telemetry.h"
+#include "../../src/ui/screens.h"
+#include "../../src/ui/trends.h"
+#include "../../src/ui/ui_queue.h"
+#include "../../src/ui/display.h"
+#include "../../src/ui/diagnostics.h"
+#include "../../src/ui/screen_cache.h"
+#include "../../src/ui/prebuild.h"
+#include "../../src/config/config.h"
+
+struct ScreenCase {
+  const char *name;
+  ScreenID id;
+  void (*go)();
+  bool golden;        // Compared against golden images
+};
+
+// Trends plots by wall clock time buckets and diagnostics shows timings,
+// so their images are not repeatable
+static const ScreenCase screens[] = {
+  { "main", SCREEN_MAIN, go_main, true },
+  { "more", SCREEN_MORE, go_more, true },
+  { "settings", SCREEN_SETTINGS, go_settings, true },
+  { "display_settings", SCREEN_DISPLAY_SETTINGS, go_display_settings, true },
+  { "backlight", SCREEN_BL, go_backlight, true },
+  { "connect", SCREEN_CONNECT_JK_DEVICE, go_connect_bms, true },
+  { "cell_voltages", SCREEN_CELL_VOLTAGES, go_cell_voltages, true },
+  { "wire_resistances", SCREEN_CELL_RESISTANCES, go_wire_resistances, true },
+  { "trends", SCREEN_TRENDS, go_trends, false },
+  { "diagnostics", SCREEN_DIAGNOSTICS, go_diagnostics, false },
+};
+
+// Answers init commands the way a JK BMS does
+static void answer_command(MockTransport *transport, const uint8_t *data, size_t length, void *context) {
+  uint8_t frame[JK_FRAME_SIZE];
+  switch (data[4]) {
+    case 0x97:
+      jk_build_device_info(frame, "MOCK-BMS", 0);
+      transport->notify(frame, sizeof(frame));
+      break;
+    case 0x96:
+      jk_build_settings(frame, jk_default_settings(16), 0);
+      transport->notify(frame, sizeof(frame));
+      break;
+  }
+}
+
+// Deterministic data that still changes every frame, so updates have work to do
+static void feed_frame(int packs, int f) {
+  JkCellInfo info = {};
+  info.cellCount = 16;
+  info.soc = 80 - f % 20;
+  info.mosDeciC = 312;
+  info.t1DeciC = 254;
+  info.t2DeciC = 261;
+  info.nominalCapacityMah = 280000;
+  info.capacityRemainMah = info.nominalCapacityMah / 100 * info.soc;
+  info.charge = info.discharge = true;
+
+  uint8_t frame[JK_FRAME_SIZE];
+  for (int i = 0; i < packs; i++) {
+    int32_t sum = 0;
+    for (int c = 0; c < 16; c++) {
+      info.cellMv[c] = 3300 + (c * 7 + f * 3 + i * 11) % 40;
+      info.wireResistMohm[c] = 20 + (c * 5 + i) % 15;
+      sum += info.cellMv[c];
+    }
+    info.packMv = sum;
+    info.currentMa = -12500 + (f % 10) * 1500 + i * 300;
+    jk_build_cell_info(frame, info, f);
+    mockTransportFor(i)->notify(frame, sizeof(frame));
+    ui_post_pack(UI_CMD_DATA_READY, i, bmsRegistry.get(i));
+  }
+}
+
+// What the UI task does with queued work before updating widgets
+static void pump() {
+  ui_queue_drain();
+  ui_telemetry_drain();
+  trends_drain();
+  diagnostics_update();
+  screen_cache_service();
+}
+
+static bool read_file(const char *path, std::vector<uint8_t> &data) {
+  FILE *f = fopen(path, "rb");
+  if (!f) return false;
+  uint8_t buf[4096];
+  size_t n;
+  data.clear();
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + n);
+  fclose(f);
+  return true;
+}
+
+int main(int argc, char **argv) {
+  int packs = 2;
+  int iterations = 50;
+  const char *outDir = nullptr;
+  const char *goldenDir = nullptr;
+  bool prebuild = false;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--packs") && i + 1 < argc) packs = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--iterations") && i + 1 < argc) iterations = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--out") && i + 1 < argc) outDir = argv[++i];
+    else if (!strcmp(argv[i], "--golden") && i + 1 < argc) goldenDir = argv[++i];
+    else if (!strcmp(argv[i], "--prebuild")) prebuild = true;
+    else {
+      printf("usage: %s [--packs N] [--iterations N] [--out DIR] [--golden DIR] [--prebuild]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (packs < 1 || packs > BMS_MAX_DEVICES) packs = 1;
+  if (iterations < 1) iterations = 1;
+
+  Serial.enabled = getenv("JKBMS_VERBOSE") != nullptr;
+  bmsRegistry.setTransportProvider(mockTransportForSlot);
+  telemetry_enable(TELEMETRY_UI, true);
+  telemetry_enable(TELEMETRY_HISTORY, true);
+  ui_queue_init();
+
+  for (int i = 0; i < packs; i++) {
+    char mac[18];
+    snprintf(mac, sizeof(mac), "00:00:00:00:00:%02x", i);
+    JKBMS *bms = bmsRegistry.add(mac);
+    mockTransportFor(i)->onWrite(answer_command, nullptr);
+    if (!bms->connectToServer()) {
+      fprintf(stderr, "pack %d failed to connect\n", i);
+      return 1;
+    }
+  }
+
+  ui_init();
+  // As the BMS task does at start, before any of their frames
+  for (int i = 0; i < packs; i++) ui_post_pack(UI_CMD_DEVICES_CHANGED, i, bmsRegistry.get(i));
+  ui_queue_drain();
+  int f = 0;
+  feed_frame(packs, f++);
+  pump();
+  lv_refr_now(NULL);
+
+  if (prebuild) {
+    delay(PREBUILD_START_DELAY);
+    // Bounded, the prebuilder keeps waiting if the pool never has room for a screen
+    for (int pass = 0; pass < 100; pass++) {
+      uint32_t wait = prebuild_service(false);
+      if (wait == UINT32_MAX) break;
+      delay(wait);
+    }
+  }
+
+  // nav: from the go_*() call to the end of the first refresh, see ScreenTiming
+  printf("%-18s %9s %9s %9s %9s %9s %9s %9s\n", "screen", "bytes", "build us", "first us", "nav us", "update us",
+         "render us", "full us");
+  bool ok = true;
+  for (const ScreenCase &s : screens) {
+    // LVGL pool taken by the screen's widgets and styles
+    lv_mem_monitor_t before, after;
+    lv_mem_monitor(&before);
+    uint32_t start = micros();
+    s.go();
+    uint32_t buildUs = micros() - start;
+    lv_mem_monitor(&after);
+    long bytes = (long)before.free_size - (long)after.free_size;
+    start = micros();
+    lv_refr_now(NULL);
+    uint32_t firstUs = micros() - start;
+
+    // Steady state: one new frame per iteration, as the UI task sees it
+    uint64_t updateUs = 0, renderUs = 0;
+    for (int i = 0; i < iterations; i++) {
+      feed_frame(packs, f++);
+      pump();
+      start = micros();
+      update_bms_display();
+      updateUs += micros() - start;
+      start = micros();
+      lv_refr_now(NULL);
+      renderUs += micros() - start;
+    }
+
+    lv_obj_invalidate(lv_screen_active());
+    start = micros();
+    lv_refr_now(NULL);
+    uint32_t fullUs = micros() - start;
+
+    const ScreenTiming *timing = screen_cache_timing(s.id);
+    unsigned long navUs = timing ? timing->lastUs : 0;
+    printf("%-18s %9ld %9lu %9lu %9lu %9lu %9lu %9lu\n", s.name, bytes, (unsigned long)buildUs, (unsigned long)firstUs,
+           navUs, (unsigned long)(updateUs / iterations), (unsigned long)(renderUs / iterations), (unsigned long)fullUs);
+
+    int width, height;
+    const uint16_t *pixels = headless_framebuffer(width, height);
+    std::vector<uint8_t> png = png_encode_rgb565(pixels, width, height);
+    char path[512];
+    if (outDir) {
+      snprintf(path, sizeof(path), "%s/%s.png", outDir, s.name);
+      if (!png_write_file(path, png)) {
+        fprintf(stderr, "could not write %s\n", path);
+        ok = false;
+      }
+    }
+    if (goldenDir && s.golden) {
+      std::vector<uint8_t> expected;
+      snprintf(path, sizeof(path), "%s/%s.png", goldenDir, s.name);
+      if (!read_file(path, expected)) {
+        fprintf(stderr, "golden %s: missing\n", path);
+        ok = false;
+      } else if (expected != png) {
+        fprintf(stderr, "golden %s: differs\n", path);
+        ok = false;
+      }
+    }
+  }
+
+  lv_mem_monitor_t mem;
+  lv_mem_monitor(&mem);
+  printf("LVGL pool: %lu of %lu bytes used (%u%%), max %lu, frag %u%%\n",
+         (unsigned long)(mem.total_size - mem.free_size), (unsigned long)mem.total_size, mem.used_pct,
+         (unsigned long)mem.max_used, mem.frag_pct);
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
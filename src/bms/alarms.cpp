@@ -0,0 +1,172 @@
+#include "alarms.h"
+#include <atomic>
+#include "../utils/utils.h"
+
+struct AlarmState {
+  AlarmLimits limits;
+  std::atomic<uint32_t> active{0};
+  std::atomic<uint8_t> highCell{0};
+  std::atomic<uint8_t> lowCell{0};
+  std::atomic<bool> changed{false};
+};
+
+static AlarmState states[BMS_MAX_DEVICES];
+
+static const char *const names[ALARM_COUNT] = {
+  "Cell high",
+  "Cell low",
+  "Cell delta",
+  "Temp high",
+  "Temp low",
+  "MOS temp high",
+  "Charge current",
+  "Discharge current",
+};
+
+static inline int32_t s32le(const uint8_t *p) {
+  return (int32_t)(p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24);
+}
+
+// A limit of 0 means the pack doesn't report it, the rule never fires
+static void set_high(int32_t limit, int32_t margin, int32_t hyst, int32_t &set, int32_t &clear) {
+  set = limit > 0 ? limit - margin : INT32_MAX;
+  clear = limit > 0 ? set - hyst : INT32_MAX;
+}
+
+// Raised at or above set, cleared below clear
+static inline bool rule_high(bool active, int32_t value, int32_t set, int32_t clear) {
+  return active ? value >= clear : value >= set;
+}
+
+// Raised at or below set, cleared above clear
+static inline bool rule_low(bool active, int32_t value, int32_t set, int32_t clear) {
+  return active ? value <= clear : value <= set;
+}
+
+// Same offsets as JKBMS::bms_settings, kept in the protocol's integer units
+void alarms_load_settings(int slot, const uint8_t *frame) {
+  if (slot < 0 || slot >= BMS_MAX_DEVICES) return;
+  AlarmLimits &l = states[slot].limits;
+
+  int32_t uvp = s32le(&frame[10]);
+  int32_t ovp = s32le(&frame[18]);
+  set_high(ovp, ALARM_CELL_MARGIN_MV, ALARM_CELL_HYST_MV, l.cellHighSet, l.cellHighClear);
+  l.cellLowSet = uvp > 0 ? uvp + ALARM_CELL_MARGIN_MV : INT32_MIN;
+  l.cellLowClear = uvp > 0 ? l.cellLowSet + ALARM_CELL_HYST_MV : INT32_MIN;
+
+  // Charge/discharge overtemperature, charge undertemperature (signed) and MOSFET overtemperature
+  set_high(s32le(&frame[82]), ALARM_TEMP_MARGIN_DECIC, ALARM_TEMP_HYST_DECIC, l.chargeTempHighSet, l.chargeTempHighClear);
+  set_high(s32le(&frame[90]), ALARM_TEMP_MARGIN_DECIC, ALARM_TEMP_HYST_DECIC, l.dischargeTempHighSet, l.dischargeTempHighClear);
+  l.tempLowSet = s32le(&frame[98]) + ALARM_TEMP_MARGIN_DECIC;
+  l.tempLowClear = l.tempLowSet + ALARM_TEMP_HYST_DECIC;
+  set_high(s32le(&frame[106]), ALARM_TEMP_MARGIN_DECIC, ALARM_TEMP_HYST_DECIC, l.mosTempHighSet, l.mosTempHighClear);
+
+  // Max currents in mA, the margins are a share of them
+  int32_t maxCharge = s32le(&frame[50]);
+  int32_t maxDischarge = s32le(&frame[62]);
+  set_high(maxCharge, maxCharge / 100 * (100 - ALARM_CURRENT_PERCENT), maxCharge / 100 * ALARM_CURRENT_HYST_PERCENT,
+           l.chargeCurrentSet, l.chargeCurrentClear);
+  set_high(maxDischarge, maxDischarge / 100 * (100 - ALARM_CURRENT_PERCENT), maxDischarge / 100 * ALARM_CURRENT_HYST_PERCENT,
+           l.dischargeCurrentSet, l.dischargeCurrentClear);
+  l.valid = true;
+
+  DEBUG_PRINTF("Alarms %d: cell %ld-%ld mV, temp %ld/%ld/%ld, mos %ld (0.1 C), current %ld/%ld mA\n", slot,
+               (long)l.cellLowSet, (long)l.cellHighSet, (long)l.tempLowSet, (long)l.chargeTempHighSet,
+               (long)l.dischargeTempHighSet, (long)l.mosTempHighSet, (long)l.chargeCurrentSet,
+               (long)l.dischargeCurrentSet);
+}
+
+uint32_t alarms_evaluate(int slot, const TelemetrySample &sample) {
+  if (slot < 0 || slot >= BMS_MAX_DEVICES) return 0;
+  AlarmState &s = states[slot];
+  const AlarmLimits &l = s.limits;
+  uint32_t was = s.active.load(std::memory_order_relaxed);
+  uint32_t now = 0;
+
+  // One pass over the cells gives both extremes and the delta
+  int32_t highMv = 0, lowMv = INT32_MAX;
+  uint8_t highCell = 0, lowCell = 0;
+  for (int i = 0; i < sample.cellCount; i++) {
+    int32_t mv = sample.cellMv[i];
+    if (mv > highMv) { highMv = mv; highCell = i + 1; }
+    if (mv < lowMv) { lowMv = mv; lowCell = i + 1; }
+  }
+
+  if (sample.cellCount > 0) {
+    if (rule_high(was & ALARM_BIT(ALARM_CELL_DELTA), highMv - lowMv, ALARM_DELTA_MV, ALARM_DELTA_MV - ALARM_DELTA_HYST_MV)) {
+      now |= ALARM_BIT(ALARM_CELL_DELTA);
+    }
+  }
+
+  if (l.valid) {
+    if (sample.cellCount > 0) {
+      if (rule_high(was & ALARM_BIT(ALARM_CELL_HIGH), highMv, l.cellHighSet, l.cellHighClear)) now |= ALARM_BIT(ALARM_CELL_HIGH);
+      if (rule_low(was & ALARM_BIT(ALARM_CELL_LOW), lowMv, l.cellLowSet, l.cellLowClear)) now |= ALARM_BIT(ALARM_CELL_LOW);
+    }
+
+    bool charging = sample.currentMa > ALARM_CHARGING_MA;
+    int32_t tempHigh = sample.t1DeciC > sample.t2DeciC ? sample.t1DeciC : sample.t2DeciC;
+    int32_t tempLow = sample.t1DeciC < sample.t2DeciC ? sample.t1DeciC : sample.t2DeciC;
+    if (charging ? rule_high(was & ALARM_BIT(ALARM_TEMP_HIGH), tempHigh, l.chargeTempHighSet, l.chargeTempHighClear)
+                 : rule_high(was & ALARM_BIT(ALARM_TEMP_HIGH), tempHigh, l.dischargeTempHighSet, l.dischargeTempHighClear)) {
+      now |= ALARM_BIT(ALARM_TEMP_HIGH);
+    }
+    // Undertemperature only protects charging
+    if (charging && rule_low(was & ALARM_BIT(ALARM_TEMP_LOW), tempLow, l.tempLowSet, l.tempLowClear)) {
+      now |= ALARM_BIT(ALARM_TEMP_LOW);
+    }
+    if (rule_high(was & ALARM_BIT(ALARM_MOS_TEMP_HIGH), sample.mosTempDeciC, l.mosTempHighSet, l.mosTempHighClear)) {
+      now |= ALARM_BIT(ALARM_MOS_TEMP_HIGH);
+    }
+
+    if (rule_high(was & ALARM_BIT(ALARM_CHARGE_CURRENT), sample.currentMa, l.chargeCurrentSet, l.chargeCurrentClear)) {
+      now |= ALARM_BIT(ALARM_CHARGE_CURRENT);
+    }
+    if (rule_high(was & ALARM_BIT(ALARM_DISCHARGE_CURRENT), -sample.currentMa, l.dischargeCurrentSet, l.dischargeCurrentClear)) {
+      now |= ALARM_BIT(ALARM_DISCHARGE_CURRENT);
+    }
+  }
+
+  s.highCell.store(now & ALARM_BIT(ALARM_CELL_HIGH) ? highCell : 0, std::memory_order_relaxed);
+  s.lowCell.store(now & ALARM_BIT(ALARM_CELL_LOW) ? lowCell : 0, std::memory_order_relaxed);
+  uint32_t transitions = was ^ now;
+  if (transitions) {
+    s.active.store(now, std::memory_order_release);
+    s.changed.store(true, std::memory_order_release);
+    DEBUG_PRINTF("Alarms %d: 0x%02lx -> 0x%02lx\n", slot, (unsigned long)was, (unsigned long)now);
+  }
+  return transitions;
+}
+
+void alarms_reset(int slot) {
+  if (slot < 0 || slot >= BMS_MAX_DEVICES) return;
+  AlarmState &s = states[slot];
+  s.limits = {};
+  s.highCell.store(0, std::memory_order_relaxed);
+  s.lowCell.store(0, std::memory_order_relaxed);
+  if (s.active.exchange(0, std::memory_order_acq_rel)) s.changed.store(true, std::memory_order_release);
+}
+
+bool alarms_take_changed(int slot) {
+  if (slot < 0 || slot >= BMS_MAX_DEVICES) return false;
+  return states[slot].changed.exchange(false, std::memory_order_acq_rel);
+}
+
+uint32_t alarms_active(int slot) {
+  if (slot < 0 || slot >= BMS_MAX_DEVICES) return 0;
+  return states[slot].active.load(std::memory_order_acquire);
+}
+
+const char *alarms_name(AlarmId id) {
+  return id >= 0 && id < ALARM_COUNT ? names[id] : "";
+}
+
+uint8_t alarms_high_cell(int slot) {
+  if (slot < 0 || slot >= BMS_MAX_DEVICES) return 0;
+  return states[slot].highCell.load(std::memory_order_relaxed);
+}
+
+uint8_t alarms_low_cell(int slot) {
+  if (slot < 0 || slot >= BMS_MAX_DEVICES) return 0;
+  return states[slot].lowCell.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Arduino.h>
+#include "telemetry.h"
+#include "../config/config.h"
+
+// Alarm engine
+// Compares every decoded sample against the pack's own protection settings.
+// When a settings frame arrives, its limits are turned into integer
+// set/clear thresholds in the sample's units (mV, mA, 0.1 C): a warning
+// margin before the BMS would trip, and a hysteresis band so a value
+// sitting on a threshold doesn't toggle the alarm on every frame.
+// Evaluation runs in the BMS task right after a frame is published and
+// only does integer compares. The active set is readable from any task.
+
+enum AlarmId {
+  ALARM_CELL_HIGH,          // Highest cell near the overvoltage protection
+  ALARM_CELL_LOW,           // Lowest cell near the undervoltage protection
+  ALARM_CELL_DELTA,         // Highest - lowest cell above ALARM_DELTA_MV
+  ALARM_TEMP_HIGH,          // Battery sensor near the charge/discharge overtemperature protection
+  ALARM_TEMP_LOW,           // Charging with a battery sensor near the undertemperature protection
+  ALARM_MOS_TEMP_HIGH,      // MOSFETs near their overtemperature protection
+  ALARM_CHARGE_CURRENT,     // Near the max charge current
+  ALARM_DISCHARGE_CURRENT,  // Near the max discharge current
+  ALARM_COUNT
+};
+
+#define ALARM_BIT(id) (1u << (id))
+
+// Thresholds of one pack. A rule is raised at or beyond set and cleared
+// once the value is back past clear.
+struct AlarmLimits {
+  bool valid;                      // Settings frame seen, only the delta rule runs before that
+  int32_t cellHighSet, cellHighClear;
+  int32_t cellLowSet, cellLowClear;
+  int32_t chargeTempHighSet, chargeTempHighClear;
+  int32_t dischargeTempHighSet, dischargeTempHighClear;
+  int32_t tempLowSet, tempLowClear;
+  int32_t mosTempHighSet, mosTempHighClear;
+  int32_t chargeCurrentSet, chargeCurrentClear;
+  int32_t dischargeCurrentSet, dischargeCurrentClear;
+};
+
+// BMS task. Derives the limits of a slot from a raw, checksum-verified settings frame.
+void alarms_load_settings(int slot, const uint8_t *frame);
+
+// BMS task. Evaluates a published sample, returns the alarms raised or cleared by it.
+uint32_t alarms_evaluate(int slot, const TelemetrySample &sample);
+
+// BMS task. Clears the alarms of a slot whose pack disconnected.
+void alarms_reset(int slot);
+
+// True once per change of a slot's alarm set, for posting a single UI event
+bool alarms_take_changed(int slot);
+
+// Any task
+uint32_t alarms_active(int slot);
+const char *alarms_name(AlarmId id);
+uint8_t alarms_high_cell(int slot);   // 1-based cell of ALARM_CELL_HIGH, 0 if none
+uint8_t alarms_low_cell(int slot);    // 1-based cell of ALARM_CELL_LOW, 0 if none
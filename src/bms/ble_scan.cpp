@@ -0,0 +1,83 @@
+#include "ble_scan.h"
+#include "jkbms.h"
+#include "registry.h"
+#include "../utils/utils.h"
+#include "../config/config.h"
+#include "../ui/ui_queue.h"
+#include "../tasks/tasks.h"
+
+// Global variables
+bool isScanning = false;
+// Appwide global vars
+NimBLEScan *pScan;
+
+class ScanCallbacks : public NimBLEScanCallbacks {
+  void onDiscovered(const NimBLEAdvertisedDevice *advertisedDevice) override {
+    //DEBUG_PRINTF("Discovered Advertised Device: %s \n", advertisedDevice->toString().c_str());
+  }
+
+  void onResult(const NimBLEAdvertisedDevice *advertisedDevice) override {
+    //DEBUG_PRINTF("BLE Device found: %s\n", advertisedDevice->toString().c_str());
+    // Runs in the NimBLE host task, the BMS task decides whether to connect
+    NimBLEAddress address = advertisedDevice->getAddress();
+    int slot = bmsRegistry.findSlot(address.toString().c_str());
+    if (slot >= 0) bms_post_link_event(BMS_LINK_FOUND, slot, 0, address.getVal(), address.getType());
+    std::string deviceName = advertisedDevice->getName();
+    std::string deviceAddress = advertisedDevice->getAddress().toString();
+    int deviceRssi = advertisedDevice->getRSSI();
+
+    // For debug purposes
+    std::string res = "Name: " + deviceName + ", Address: " + deviceAddress;
+
+    if (advertisedDevice->haveManufacturerData()) {
+      auto mfgData  = advertisedDevice->getManufacturerData();
+      res          += ", manufacturer data: ";
+      std::string str_mfgData = NimBLEUtils::dataToHexString(reinterpret_cast<const uint8_t *>(mfgData.data()), mfgData.length());
+      res += str_mfgData;
+      // Device types (add more in future)
+      // TODO: Create struct, class, or enum to allow more device types
+      std::string BMS_B1A8S10P = "650b88a0c84780234f95";
+      // Filter to JK devices
+      if(strcmp(BMS_B1A8S10P.c_str(), str_mfgData.c_str())) {
+        DEBUG_PRINTF("Found JK device! %s\n", res.c_str());
+        // Runs in the NimBLE host task, the UI task adds the row
+        ui_post_device_row(UI_CMD_ADD_DEVICE_ROW, deviceName.c_str(), deviceAddress.c_str(), deviceRssi);
+      }
+    }
+
+    DEBUG_PRINTF("Device info: %s\n", res.c_str());
+
+    
+
+    // Following is some commented code that may come in handy in the future:
+    //const char *mac_addr = advertisedDevice->getAddress().toString().c_str();
+    //uint8_t rssi = advertisedDevice->getRSSI();
+    //std::string p_mac_addr = advertisedDevice->getAddress().toString().c_str();
+    //DEBUG_PRINTF("Name: %s RSSI: %d MAC: %s\n Mfgr data: %s", name, rssi, mac_addr, mfgr_data_str);
+  }
+
+    void onScanEnd(const NimBLEScanResults& results, int reason) override {
+      DEBUG_PRINTF("Scan Ended; reason = %d\n", reason);
+      isScanning = false;
+    }
+} scanCallbacks;
+
+// Setup BLE scanning without starting it
+void initScan() {
+  pScan = NimBLEDevice::getScan();
+  pScan->setScanCallbacks(&scanCallbacks);
+  pScan->setActiveScan(true);
+  pScan->setInterval(BLE_SCAN_INTERVAL);
+  pScan->setWindow(BLE_SCAN_WINDOW);
+}
+
+// Scan for JK devices
+void scanForDevices() {
+  if(!isScanning) {
+    isScanning = true;
+    DEBUG_PRINTLN("Starting scan...");
+    pScan->start(BLE_SCAN_TIME);
+  }else{
+    DEBUG_PRINTLN("Already scanning!");
+  }
+}
\ No newline at end of file
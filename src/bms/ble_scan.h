@@ -0,0 +1,8 @@
+#pragma once
+
+#include <NimBLEDevice.h>
+
+void initScan();
+void scanForDevices();
+
+extern NimBLEScan *pScan; // defined in ble_scan.cpp, also used in main.cpp
@@ -1,16 +1,13 @@
 #include "jkbms.h"
 #include "../utils/utils.h"
 #include "../config/config.h"
-#include "../ui/screens.h"
+#include "registry.h"
+#include "telemetry.h"
+#include "alarms.h"
 
-
-// Global variables
-bool isScanning = false;
-// Appwide global vars
-NimBLEScan *pScan;
-
-
-JKBMS::JKBMS(const std::string& mac) : targetMAC(mac) {}
+JKBMS::JKBMS(const char *mac) {
+  strlcpy(targetMAC, mac, sizeof(targetMAC));
+}
 
 uint8_t JKBMS::crc(const uint8_t data[], uint16_t len) {
   uint8_t crc = 0;
@@ -18,101 +15,141 @@ uint8_t JKBMS::crc(const uint8_t data[], uint16_t len) {
   return crc;
 }
 
+// True while a known device should still be tried by address before scanning
+bool JKBMS::wantsDirectConnect() const {
+  return !connected && !connecting && !doConnect && directConnectAttempts < BMS_DIRECT_CONNECT_ATTEMPTS;
+}
+
 bool JKBMS::connectToServer() {
-  DEBUG_PRINTF("Attempting to connect to %s...\n", targetMAC.c_str());
-  NimBLEClient *pClient = NimBLEDevice::getClientByPeerAddress(advDevice->getAddress());
-
-  if (!pClient) {
-    pClient = NimBLEDevice::createClient();
-    DEBUG_PRINTLN("New client created.");
-    pClient->setClientCallbacks(new ClientCallbacks(this), true);
-    pClient->setConnectionParams(12, 12, 0, 150);
-    pClient->setConnectTimeout(5000);
+  if (!transport) {
+    DEBUG_PRINTF("No transport for %s\n", targetMAC);
+    return false;
   }
 
-  if (!pClient->connect(advDevice)) {
-    DEBUG_PRINTF("Failed to connect to %s\n", targetMAC.c_str());
+  if (!transport->connect(targetMAC)) {
+    DEBUG_PRINTF("Failed to connect to %s\n", targetMAC);
     return false;
   }
+  if (!transport->subscribe()) {
+    DEBUG_PRINTLN("Service or Characteristic not found or unable to subscribe.");
+    transport->disconnect();
+    return false;
+  }
+
+  onLinkUp(transport->connHandle(), transport->mtu());
+  while (serviceInit()) delay(BMS_INIT_COMMAND_DELAY);
+  return true;
+}
 
-  DEBUG_PRINTF("Connected to: %s RSSI: %d\n", pClient->getPeerAddress().toString().c_str(), pClient->getRssi());
-
-  NimBLERemoteService *pSvc = pClient->getService("ffe0");
-  if (pSvc) {
-    pChr = pSvc->getCharacteristic("ffe1");
-    if (pChr && pChr->canNotify()) {
-      if (pChr->subscribe(true, notifyCB)) {
-        DEBUG_PRINTF("Subscribed to notifications for %s\n", pChr->getUUID().toString().c_str());
-        delay(500);
-        writeRegister(0x97, 0x00000000, 0x00);  // COMMAND_DEVICE_INFO
-        delay(500);
-        writeRegister(0x96, 0x00000000, 0x00);  // COMMAND_CELL_INFO
-        return true;
-      }
-    }
+bool JKBMS::serviceInit() {
+  if (!initStep) return false;
+  if ((int32_t)(millis() - initDueMs) < 0) return true;
+
+  if (initStep == 1) {
+    writeRegister(0x97, 0x00000000, 0x00);  // COMMAND_DEVICE_INFO
+    initStep = 2;
+    initDueMs = millis() + BMS_INIT_COMMAND_DELAY;
+    return true;
   }
-  DEBUG_PRINTLN("Service or Characteristic not found or unable to subscribe.");
+  writeRegister(0x96, 0x00000000, 0x00);  // COMMAND_CELL_INFO
+  initStep = 0;
   return false;
 }
 
+void JKBMS::onLinkUp(uint16_t handle, uint16_t mtu) {
+  DEBUG_PRINTF("Connected to %s, MTU %u\n", targetMAC, mtu);
+  connected = true;
+  directConnectAttempts = 0;
+  negotiatedMTU = mtu;
+  lastNotifyTime = millis();  // The connection timeout counts from here, not from the last session
+  bmsRegistry.bindConnHandle(handle, this);
+  // Subscribed, the BMS needs a moment before it takes commands
+  initStep = 1;
+  initDueMs = millis() + BMS_INIT_COMMAND_DELAY;
+}
+
+void JKBMS::onDisconnected(int reason) {
+  DEBUG_PRINTF("%s disconnected, reason: %d\n", targetMAC, reason);
+  if (connected) bmsRegistry.unbindConnHandle(connHandle);
+  connected = false;
+  initStep = 0;
+  doConnect = false;
+}
+
+void JKBMS::onMtuChanged(uint16_t mtu) {
+  DEBUG_PRINTF("%s MTU changed to %u\n", targetMAC, mtu);
+  negotiatedMTU = mtu;
+}
+
 void JKBMS::handleNotification(uint8_t *pData, size_t length) {
   DEBUG_PRINTLN("Handling notification...");
   lastNotifyTime = millis();
 
-  if (ignoreNotifyCount > 0) {
-    ignoreNotifyCount--;
-    DEBUG_PRINTF("Ignoring notification. Remaining: %d\n", ignoreNotifyCount);
-    return;
-  }
-
-  // Check for start of data frame
-  if (pData[0] == 0x55 && pData[1] == 0xAA && pData[2] == 0xEB && pData[3] == 0x90) {
+  // Check for start of data frame. Every frame is taken: bytes arriving
+  // outside a frame are dropped until the next header, and the checksum
+  // rejects torn frames.
+  if (length >= 4 && pData[0] == 0x55 && pData[1] == 0xAA && pData[2] == 0xEB && pData[3] == 0x90) {
     DEBUG_PRINTLN("Start of data frame detected.");
     frame = 0;
+    frameNotifyCount = 0;
     received_start = true;
     received_complete = false;
-
-    // Store the received data
-    for (int i = 0; i < length; i++) {
-      receivedBytes[frame++] = pData[i];
-    }
   } else if (received_start && !received_complete) {
     DEBUG_PRINTLN("Continuing data frame...");
-    for (int i = 0; i < length; i++) {
-      receivedBytes[frame++] = pData[i];
-      if (frame >= 300) {
-        received_complete = true;
-        received_start = false;
-        new_data = true;
-        DEBUG_PRINTLN("New data available for parsing.");
-
-        // Determine the type of data frame based on pData[4]
-        switch (receivedBytes[4]) {  // Use receivedBytes[4] instead of pData[4]
-          case 0x01:
-            DEBUG_PRINTLN("BMS Settings frame detected.");
-            bms_settings();
-            break;
-          case 0x02:
-            DEBUG_PRINTLN("Cell data frame detected.");
-            parseData();
-            break;
-          case 0x03:
-            DEBUG_PRINTLN("Device info frame detected.");
-            parseDeviceInfo();
-            break;
-          default:
-            DEBUG_PRINTF("Unknown frame type: 0x%02X\n", receivedBytes[4]);
-            break;
-        }
-
-        break;  // Exit the loop after processing the complete frame
-      }
-    }
+  } else {
+    return;
   }
+
+  // Copy the whole chunk at once. With a large MTU the header chunk may
+  // already hold the complete frame, so completion is checked for every chunk.
+  frameNotifyCount++;
+  size_t take = JK_FRAME_SIZE - frame;
+  if (length < take) take = length;
+  memcpy(receivedBytes + frame, pData, take);
+  frame += take;
+
+  if (frame < JK_FRAME_SIZE) return;
+
+  received_complete = true;
+  received_start = false;
+  lastFrameNotifyCount = frameNotifyCount;
+
+  // The last byte is the sum of all others; drop corrupted frames
+  if (crc(receivedBytes, JK_FRAME_SIZE - 1) != receivedBytes[JK_FRAME_SIZE - 1]) {
+    crcErrors++;
+    DEBUG_PRINTF("CRC mismatch, frame dropped (%lu so far).\n", (unsigned long)crcErrors);
+    return;
+  }
+
+  new_data = true;
+  framesReceived++;
+  DEBUG_PRINTF("New data available for parsing (%u notifications, MTU %u).\n", lastFrameNotifyCount, negotiatedMTU);
+
+  // Determine the type of data frame based on receivedBytes[4]
+  uint32_t parseStart = micros();
+  switch (receivedBytes[4]) {
+    case 0x01:
+      DEBUG_PRINTLN("BMS Settings frame detected.");
+      bms_settings();
+      break;
+    case 0x02:
+      DEBUG_PRINTLN("Cell data frame detected.");
+      parseData();
+      break;
+    case 0x03:
+      DEBUG_PRINTLN("Device info frame detected.");
+      parseDeviceInfo();
+      break;
+    default:
+      DEBUG_PRINTF("Unknown frame type: 0x%02X\n", receivedBytes[4]);
+      break;
+  }
+  lastParseUs = micros() - parseStart;
+  if (lastParseUs > maxParseUs) maxParseUs = lastParseUs;
 }
 
 void JKBMS::writeRegister(uint8_t address, uint32_t value, uint8_t length) {
-  DEBUG_PRINTF("Writing register: address=0x%02X, value=0x%08lX, length=%d\n", address, value, length);
+  DEBUG_PRINTF("Writing register: address=0x%02X, value=0x%08lX, length=%d\n", address, (unsigned long)value, length);
   uint8_t frame[20] = { 0xAA, 0x55, 0x90, 0xEB, address, length };
 
   // Insert value (Little-Endian)
@@ -131,8 +168,8 @@ void JKBMS::writeRegister(uint8_t address, uint32_t value, uint8_t length) {
   }
   DEBUG_PRINTF("\n");
 
-  if (pChr) {
-    pChr->writeValue((uint8_t *)frame, (size_t)sizeof(frame));
+  if (transport) {
+    transport->write(frame, sizeof(frame));
   }
 }
 
@@ -164,6 +201,7 @@ void JKBMS::bms_settings() {
   total_battery_capacity = ((receivedBytes[133] << 24 | receivedBytes[132] << 16 | receivedBytes[131] << 8 | receivedBytes[130]) * 0.001);
   short_circuit_protection_delay = ((receivedBytes[137] << 24 | receivedBytes[136] << 16 | receivedBytes[135] << 8 | receivedBytes[134]) * 1);
   balance_starting_voltage = ((receivedBytes[141] << 24 | receivedBytes[140] << 16 | receivedBytes[139] << 8 | receivedBytes[138]) * 0.001);
+  alarms_load_settings(bmsRegistry.slotOf(this), receivedBytes);
 
   DEBUG_PRINTF("Cell voltage undervoltage protection: %.2fV\n", cell_voltage_undervoltage_protection);
   DEBUG_PRINTF("Cell voltage undervoltage recovery: %.2fV\n", cell_voltage_undervoltage_recovery);
@@ -243,7 +281,11 @@ void JKBMS::parseDeviceInfo() {
 void JKBMS::parseData() {
   DEBUG_PRINTLN("Parsing data...");
   new_data = false;
-  ignoreNotifyCount = 10;
+
+  if (firstReadingTime == 0) {
+    firstReadingTime = millis();
+    DEBUG_PRINTF("%s: boot to first reading took %lu ms\n", targetMAC, (unsigned long)firstReadingTime);
+  }
   // Cell voltages
   int cell_count_offset = 7; // data offset
   for (int j = 0, i = cell_count_offset; i < cell_count_offset + (cell_count * 2); j++, i += 2) {
@@ -320,8 +362,19 @@ void JKBMS::parseData() {
     Balance = false;
   }
 
+  // Hand the frame downstream so consumers see every reading, not just the latest
+  TelemetrySample sample;
+  telemetry_sample_from_frame(receivedBytes, cell_count, sample);
+  sample.timeMs = millis();
+  sample.rxUs = lastRxUs ? lastRxUs : micros();
+  sample.seq = ++cellFramesParsed;
+  int slot = bmsRegistry.slotOf(this);
+  telemetry_publish(slot, sample);
+  alarms_evaluate(slot, sample);
+
   // Output values
-  DEBUG_PRINTF("\n--- Data from %s ---\n", targetMAC.c_str());
+  DEBUG_PRINTF("\n--- Data from %s ---\n", targetMAC);
+  DEBUG_PRINTF("MTU: %u, notifications per frame: %u\n", negotiatedMTU, lastFrameNotifyCount);
   DEBUG_PRINTLN("Cell Voltages:");
   for (int j = 0; j < 16; j++) {
     DEBUG_PRINTF("  Cell %02d: %.3f V\n", j + 1, cellVoltage[j]);
@@ -350,103 +403,3 @@ void JKBMS::parseData() {
   DEBUG_PRINTF("Balance: %d\n", Balance);
   DEBUG_PRINTF("Balancing Action: %d\n", Balancing_Action);
 }
-
-// Callbacks implementation
-ClientCallbacks::ClientCallbacks(JKBMS *bmsInstance) : bms(bmsInstance) {}
-
-void ClientCallbacks::onConnect(NimBLEClient *pClient) {
-  DEBUG_PRINTF("Connected to %s\n", bms->targetMAC.c_str());
-  bms->connected = true;
-}
-
-void ClientCallbacks::onDisconnect(NimBLEClient *pClient, int reason) {
-  DEBUG_PRINTF("%s disconnected, reason: %d\n", bms->targetMAC.c_str(), reason);
-  bms->connected = false;
-  bms->doConnect = false;
-}
-
-class ScanCallbacks : public NimBLEScanCallbacks {
-  void onDiscovered(const NimBLEAdvertisedDevice *advertisedDevice) override {
-    //DEBUG_PRINTF("Discovered Advertised Device: %s \n", advertisedDevice->toString().c_str());
-  }
-
-  void onResult(const NimBLEAdvertisedDevice *advertisedDevice) override {
-    //DEBUG_PRINTF("BLE Device found: %s\n", advertisedDevice->toString().c_str());
-    for (int i = 0; i < bmsDeviceCount; i++) {
-      if (jkBmsDevices[i].targetMAC.empty()) continue;  // Skip empty MAC addresses
-      if (advertisedDevice->getAddress().toString() == jkBmsDevices[i].targetMAC && !jkBmsDevices[i].connected && !jkBmsDevices[i].doConnect) {
-        DEBUG_PRINTF("Found target device: %s\n", jkBmsDevices[i].targetMAC.c_str());
-        jkBmsDevices[i].advDevice = advertisedDevice;
-        jkBmsDevices[i].doConnect = true;
-        NimBLEDevice::getScan()->stop();
-      }
-    }
-    // TODO: Make the following info available to screens.cpp to use the results
-    // of the scan to populate the device list.
-
-    std::string deviceName = advertisedDevice->getName();
-    std::string deviceAddress = advertisedDevice->getAddress().toString();
-    uint8_t deviceRssi = advertisedDevice->getRSSI();
-
-    // For debug purposes
-    std::string res = "Name: " + deviceName + ", Address: " + deviceAddress;
-
-    if (advertisedDevice->haveManufacturerData()) {
-      auto mfgData  = advertisedDevice->getManufacturerData();
-      res          += ", manufacturer data: ";
-      std::string str_mfgData = NimBLEUtils::dataToHexString(reinterpret_cast<const uint8_t *>(mfgData.data()), mfgData.length());
-      res += str_mfgData;
-      // Device types (add more in future)
-      // TODO: Create struct, class, or enum to allow more device types
-      std::string BMS_B1A8S10P = "650b88a0c84780234f95";
-      // Filter to JK devices
-      if(strcmp(BMS_B1A8S10P.c_str(), str_mfgData.c_str())) {
-        DEBUG_PRINTF("Found JK device! %s\n", res.c_str());
-        // TODO: add logic to make device info available to screens for display in the list
-        create_device_list_button(deviceName.c_str(), deviceAddress.c_str());
-      }
-    }
-
-    DEBUG_PRINTF("Device info: %s\n", res.c_str());
-
-    
-
-    // Following is some commented code that may come in handy in the future:
-    //const char *mac_addr = advertisedDevice->getAddress().toString().c_str();
-    //uint8_t rssi = advertisedDevice->getRSSI();
-    //std::string p_mac_addr = advertisedDevice->getAddress().toString().c_str();
-    //DEBUG_PRINTF("Name: %s RSSI: %d MAC: %s\n Mfgr data: %s", name, rssi, mac_addr, mfgr_data_str);
-  }
-
-    void onScanEnd(const NimBLEScanResults& results, int reason) override {
-      DEBUG_PRINTF("Scan Ended; reason = %d\n", reason);
-      isScanning = false;
-    }
-} scanCallbacks;
-
-void notifyCB(NimBLERemoteCharacteristic *pChr, uint8_t *pData, size_t length, bool isNotify) {
-  DEBUG_PRINTLN("Notification received...");
-  for (int i = 0; i < bmsDeviceCount; i++) {
-    if (jkBmsDevices[i].pChr == pChr) {
-      jkBmsDevices[i].handleNotification(pData, length);
-      break;
-    }
-  }
-}
-
-// Scan for JK devices
-void scanForDevices() {
-  if(!isScanning) {
-    // Setup BLE scanning
-    isScanning = true;
-    DEBUG_PRINTLN("Starting scan...");
-    pScan = NimBLEDevice::getScan();
-    pScan->setScanCallbacks(&scanCallbacks);
-    pScan->setActiveScan(true);
-    pScan->setInterval(BLE_SCAN_INTERVAL);
-    pScan->setWindow(BLE_SCAN_WINDOW);
-    pScan->start(BLE_SCAN_TIME);
-  }else{
-    DEBUG_PRINTLN("Already scanning!");
-  }
-}
\ No newline at end of file
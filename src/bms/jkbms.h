@@ -1,20 +1,30 @@
 #pragma once
 
 #include <Arduino.h>
-#include <NimBLEDevice.h>
 #include <string>
+#include "transport.h"
+
+// Size of a JK02 response frame (settings, cell data and device info)
+#define JK_FRAME_SIZE 300
 
 class JKBMS {
 public:
-  JKBMS(const std::string& mac);
+  JKBMS() = default;
+  JKBMS(const char *mac);
 
-  // BLE Components
-  NimBLERemoteCharacteristic *pChr = nullptr;
-  const NimBLEAdvertisedDevice *advDevice = nullptr;
+  // Connection state
+  BmsTransport *transport = nullptr;  // Assigned by BmsRegistry
   bool doConnect = false;
   bool connected = false;
+  bool connecting = false;            // Handed to the connect task, waiting for its link event
   uint32_t lastNotifyTime = 0;
-  std::string targetMAC;
+  uint32_t lastRxUs = 0;              // micros() the notification being handled was received, 0 if unknown
+  char targetMAC[18] = "";            // Fixed size so each device has a fixed memory cost
+  uint16_t connHandle = 0;            // Valid while connected, see BmsRegistry
+  uint8_t directConnectAttempts = 0;  // Reset on every successful connect
+  uint32_t firstReadingTime = 0;      // millis() of the first parsed cell frame since boot
+  uint8_t initStep = 0;               // Init commands still to send after onLinkUp(), see serviceInit()
+  uint32_t initDueMs = 0;
 
   // Data Processing
   byte receivedBytes[320];
@@ -22,7 +32,14 @@ public:
   bool received_start = false;
   bool received_complete = false;
   bool new_data = false;
-  int ignoreNotifyCount = 0;
+  uint16_t negotiatedMTU = 23;        // ATT default until the exchange completes
+  uint16_t frameNotifyCount = 0;      // Notifications received for the frame in progress
+  uint16_t lastFrameNotifyCount = 0;  // Notifications the last complete frame arrived in
+  uint32_t framesReceived = 0;        // Complete frames that passed the checksum
+  uint32_t crcErrors = 0;
+  uint32_t cellFramesParsed = 0;      // Also the seq of the last published TelemetrySample
+  uint32_t lastParseUs = 0;           // Decode time of the last complete frame
+  uint32_t maxParseUs = 0;
 
   // BMS Data Fields
   float cellVoltage[16] = { 0 };
@@ -76,35 +93,27 @@ public:
   float balance_starting_voltage = 0;
 
   // Methods
+  bool wantsDirectConnect() const;
+  // Blocking connect and init for host tools and tests. The firmware connects
+  // in its connect task and sends the init commands from serviceInit().
   bool connectToServer();
+  // Sends the next init command once it is due, returns true while some are left
+  bool serviceInit();
   void parseDeviceInfo();
   void parseData();
   void bms_settings();
   void writeRegister(uint8_t address, uint32_t value, uint8_t length);
   void handleNotification(uint8_t *pData, size_t length);
 
+  // Transport events, only called by the task that owns the device
+  void onLinkUp(uint16_t handle, uint16_t mtu);
+  void onDisconnected(int reason);
+  void onMtuChanged(uint16_t mtu);
+
 private:
   uint8_t crc(const uint8_t data[], uint16_t len);
 };
 
-// BLE Callbacks
-class ClientCallbacks : public NimBLEClientCallbacks {
-  JKBMS *bms;
-public:
-  ClientCallbacks(JKBMS *bmsInstance);
-  void onConnect(NimBLEClient *pClient);
-  void onDisconnect(NimBLEClient *pClient, int reason);
-};
-
-// Global callback function for notifications
-void notifyCB(NimBLERemoteCharacteristic *pChr, uint8_t *pData, size_t length, bool isNotify);
-
-void scanForDevices();
-
-// Global BMS device array - defined in main.cpp
-extern JKBMS jkBmsDevices[];
-extern const int bmsDeviceCount;
-extern NimBLEScan *pScan; // defined in jkbms.cpp, also used in main.cpp
 extern std::string BMS_B1A8S10P;
 extern std::string deviceName;    // defined in jkbms.cpp
-extern std::string deviceAddress; // defined in jkbms.cpp
\ No newline at end of file
+extern std::string deviceAddress; // defined in jkbms.cpp
@@ -0,0 +1,67 @@
+#include "mock_transport.h"
+#include "jkbms.h"
+#include "../config/config.h"
+
+// ATT notification header size
+#define ATT_NOTIFY_OVERHEAD 3
+
+static MockTransport mockTransports[BMS_MAX_DEVICES];
+
+BmsTransport *mockTransportForSlot(int slot) {
+  return &mockTransports[slot];
+}
+
+MockTransport *mockTransportFor(int slot) {
+  if (slot < 0 || slot >= BMS_MAX_DEVICES) return nullptr;
+  return &mockTransports[slot];
+}
+
+void MockTransport::onWrite(WriteHandler handler, void *context) {
+  writeHandler = handler;
+  writeContext = context;
+}
+
+void MockTransport::notify(const uint8_t *data, size_t length) {
+  size_t chunk = mtuValue > ATT_NOTIFY_OVERHEAD ? mtuValue - ATT_NOTIFY_OVERHEAD : 1;
+  for (size_t offset = 0; offset < length; offset += chunk) {
+    size_t n = length - offset < chunk ? length - offset : chunk;
+    notifyChunk(data + offset, n);
+  }
+}
+
+void MockTransport::notifyChunk(const uint8_t *data, size_t length) {
+  if (!owner || !subscribed) return;
+  // handleNotification() takes a mutable buffer like the NimBLE callback
+  owner->handleNotification(const_cast<uint8_t *>(data), length);
+}
+
+bool MockTransport::connect(const char *mac) {
+  if (!connectResult) return false;
+  linked = true;
+  return true;
+}
+
+// One handle per mock, like one connection per pack
+uint16_t MockTransport::connHandle() const {
+  return this - mockTransports;
+}
+
+bool MockTransport::subscribe() {
+  subscribed = linked && subscribeResult;
+  return subscribed;
+}
+
+bool MockTransport::write(const uint8_t *data, size_t length) {
+  if (!linked) return false;
+  writes++;
+  if (length > 4) lastAddress = data[4];
+  if (writeHandler) writeHandler(this, data, length, writeContext);
+  return true;
+}
+
+void MockTransport::disconnect() {
+  if (!linked) return;
+  linked = false;
+  subscribed = false;
+  if (owner) owner->onDisconnected(0);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "transport.h"
+
+// In-process BmsTransport for the native (Linux) build.
+// It records register writes and lets the caller feed notifications as if
+// they came from a BMS, so the connect->init->stream sequence in jkbms.cpp
+// runs without a radio.
+class MockTransport : public BmsTransport {
+public:
+  // Called for every write, e.g. to answer a command with frames
+  typedef void (*WriteHandler)(MockTransport *transport, const uint8_t *data, size_t length, void *context);
+
+  // Behaviour knobs
+  bool connectResult = true;
+  bool subscribeResult = true;
+  uint16_t mtuValue = 23;
+
+  void onWrite(WriteHandler handler, void *context);
+
+  // Deliver bytes to the owner, split into notifications of at most MTU - 3 bytes
+  void notify(const uint8_t *data, size_t length);
+  // Deliver exactly one notification
+  void notifyChunk(const uint8_t *data, size_t length);
+
+  bool isConnected() const { return linked; }
+  bool isSubscribed() const { return subscribed; }
+  uint32_t writeCount() const { return writes; }
+  uint8_t lastCommand() const { return lastAddress; }  // Register address of the last write
+  JKBMS *getOwner() const { return owner; }
+
+  bool connect(const char *mac) override;
+  bool subscribe() override;
+  bool write(const uint8_t *data, size_t length) override;
+  void disconnect() override;
+  uint16_t mtu() const override { return mtuValue; }
+  uint16_t connHandle() const override;
+
+private:
+  bool linked = false;
+  bool subscribed = false;
+  uint32_t writes = 0;
+  uint8_t lastAddress = 0;
+  WriteHandler writeHandler = nullptr;
+  void *writeContext = nullptr;
+};
+
+// Transport provider for BmsRegistry in the native build
+BmsTransport *mockTransportForSlot(int slot);
+MockTransport *mockTransportFor(int slot);
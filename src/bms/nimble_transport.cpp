@@ -0,0 +1,99 @@
+#include "nimble_transport.h"
+#include "jkbms.h"
+#include "registry.h"
+#include "../utils/utils.h"
+#include "../config/config.h"
+#include "../tasks/tasks.h"
+
+static NimBleTransport nimbleTransports[BMS_MAX_DEVICES];
+
+BmsTransport *nimbleTransportForSlot(int slot) {
+  return &nimbleTransports[slot];
+}
+
+// Transports never move, so the slot is known without touching the registry
+static int slot_of(const NimBleTransport *transport) {
+  return transport - nimbleTransports;
+}
+
+NimBleTransport *nimbleTransportFor(JKBMS *bms) {
+  int slot = bmsRegistry.slotOf(bms);
+  return slot < 0 ? nullptr : &nimbleTransports[slot];
+}
+
+bool NimBleTransport::connect(const char *mac) {
+  // Address of the peer, as advertised if the scan found it, otherwise
+  // built from the configured MAC. A later attempt must not reuse it.
+  bool scanned = !scanAddress.isNull();
+  NimBLEAddress peerAddress = scanned ? scanAddress : NimBLEAddress(mac, BMS_ADDRESS_TYPE);
+  scanAddress = NimBLEAddress();
+  DEBUG_PRINTF("Attempting to connect to %s (%s)...\n", mac, scanned ? "scan result" : "direct");
+
+  if (!pClient) pClient = NimBLEDevice::getClientByPeerAddress(peerAddress);
+  if (!pClient) {
+    pClient = NimBLEDevice::createClient();
+    DEBUG_PRINTLN("New client created.");
+    pClient->setClientCallbacks(new ClientCallbacks(this), true);
+    pClient->setConnectionParams(12, 12, 0, 150);
+    pClient->setConnectTimeout(5000);
+  }
+
+  if (!pClient->connect(peerAddress)) return false;
+
+  DEBUG_PRINTF("Connected to: %s RSSI: %d\n", pClient->getPeerAddress().toString().c_str(), pClient->getRssi());
+
+  // The MTU exchange runs as part of connect(); larger link-layer packets
+  // let one notification carry a whole frame
+  pClient->setDataLen(251);
+  return true;
+}
+
+bool NimBleTransport::subscribe() {
+  NimBLERemoteService *pSvc = pClient ? pClient->getService("ffe0") : nullptr;
+  if (!pSvc) return false;
+  pChr = pSvc->getCharacteristic("ffe1");
+  return pChr && pChr->canNotify() && pChr->subscribe(true, notifyCB);
+}
+
+bool NimBleTransport::write(const uint8_t *data, size_t length) {
+  if (!pChr) return false;
+  return pChr->writeValue(data, length);
+}
+
+void NimBleTransport::disconnect() {
+  if (pClient) pClient->disconnect();
+}
+
+void NimBleTransport::release() {
+  // Deleting the client disconnects it and frees its callbacks
+  if (pClient) NimBLEDevice::deleteClient(pClient);
+  pClient = nullptr;
+  pChr = nullptr;
+  scanAddress = NimBLEAddress();
+}
+
+uint16_t NimBleTransport::mtu() const {
+  return pClient ? pClient->getMTU() : 23;
+}
+
+uint16_t NimBleTransport::connHandle() const {
+  return pClient ? pClient->getConnHandle() : 0;
+}
+
+// Callbacks implementation
+// These run in the NimBLE host task. They never touch the JKBMS or the
+// registry, the BMS task applies the events in order.
+ClientCallbacks::ClientCallbacks(NimBleTransport *transportInstance) : transport(transportInstance) {}
+
+void ClientCallbacks::onMTUChange(NimBLEClient *pClient, uint16_t mtu) {
+  bms_post_link_event(BMS_LINK_MTU, slot_of(transport), mtu);
+}
+
+void ClientCallbacks::onDisconnect(NimBLEClient *pClient, int reason) {
+  bms_post_link_event(BMS_LINK_DISCONNECTED, slot_of(transport), reason);
+}
+
+// Only copy the bytes, the BMS task resolves the handle and decodes them
+void notifyCB(NimBLERemoteCharacteristic *pChr, uint8_t *pData, size_t length, bool isNotify) {
+  bms_post_notification(pChr->getRemoteService()->getClient()->getConnHandle(), pData, length);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <NimBLEDevice.h>
+#include "transport.h"
+
+// BmsTransport on top of the NimBLE client
+class NimBleTransport : public BmsTransport {
+public:
+  // Advertised address, set by the BMS task when the scan found the device.
+  // Used by the next connect() only; without it connect() goes straight to
+  // the configured address.
+  NimBLEAddress scanAddress;
+
+  bool connect(const char *mac) override;
+  bool subscribe() override;
+  bool write(const uint8_t *data, size_t length) override;
+  void disconnect() override;
+  void release() override;
+  uint16_t mtu() const override;
+  uint16_t connHandle() const override;
+
+  JKBMS *getOwner() const { return owner; }
+
+private:
+  NimBLEClient *pClient = nullptr;
+  NimBLERemoteCharacteristic *pChr = nullptr;
+};
+
+// BLE Callbacks
+class ClientCallbacks : public NimBLEClientCallbacks {
+  NimBleTransport *transport;
+public:
+  ClientCallbacks(NimBleTransport *transportInstance);
+  void onMTUChange(NimBLEClient *pClient, uint16_t mtu);
+  void onDisconnect(NimBLEClient *pClient, int reason);
+};
+
+// Global callback function for notifications
+void notifyCB(NimBLERemoteCharacteristic *pChr, uint8_t *pData, size_t length, bool isNotify);
+
+// Transport provider for BmsRegistry, one transport per registry slot
+BmsTransport *nimbleTransportForSlot(int slot);
+NimBleTransport *nimbleTransportFor(JKBMS *bms);
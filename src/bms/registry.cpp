@@ -0,0 +1,131 @@
+#include "registry.h"
+#include "../utils/utils.h"
+
+#define HANDLE_SLOT_EMPTY -1
+#define HANDLE_SLOT_DELETED -2
+
+BmsRegistry bmsRegistry;
+
+BmsRegistry::BmsRegistry() {
+  for (int i = 0; i < BMS_MAX_DEVICES; i++) used[i] = false;
+  for (int i = 0; i < BMS_HANDLE_MAP_SIZE; i++) {
+    mapHandle[i] = 0;
+    mapSlot[i] = HANDLE_SLOT_EMPTY;
+  }
+}
+
+JKBMS *BmsRegistry::add(const char *mac) {
+  JKBMS *existing = find(mac);
+  if (existing) return existing;
+
+  for (int i = 0; i < BMS_MAX_DEVICES; i++) {
+    if (used[i]) continue;
+    devices[i] = JKBMS(mac);
+    devices[i].transport = transportProvider ? transportProvider(i) : nullptr;
+    if (devices[i].transport) devices[i].transport->attach(&devices[i]);
+    portENTER_CRITICAL(&usedLock);
+    used[i] = true;
+    portEXIT_CRITICAL(&usedLock);
+    deviceCount++;
+    DEBUG_PRINTF("Registered %s in slot %d\n", mac, i);
+    return &devices[i];
+  }
+  DEBUG_PRINTF("Registry full, cannot add %s\n", mac);
+  return nullptr;
+}
+
+bool BmsRegistry::remove(const char *mac) {
+  JKBMS *bms = find(mac);
+  if (!bms) return false;
+
+  if (bms->connected) unbindConnHandle(bms->connHandle);
+
+  if (bms->transport) {
+    bms->transport->release();
+    bms->transport->attach(nullptr);
+  }
+
+  // Free the slot for findSlot() before its MAC is cleared
+  int slot = bms - devices;
+  portENTER_CRITICAL(&usedLock);
+  used[slot] = false;
+  portEXIT_CRITICAL(&usedLock);
+  devices[slot] = JKBMS();
+  deviceCount--;
+  DEBUG_PRINTF("Removed %s from slot %d\n", mac, slot);
+  return true;
+}
+
+JKBMS *BmsRegistry::find(const char *mac) {
+  for (int i = 0; i < BMS_MAX_DEVICES; i++) {
+    if (used[i] && strcasecmp(devices[i].targetMAC, mac) == 0) return &devices[i];
+  }
+  return nullptr;
+}
+
+int BmsRegistry::findSlot(const char *mac) {
+  int slot = -1;
+  portENTER_CRITICAL(&usedLock);
+  for (int i = 0; i < BMS_MAX_DEVICES && slot < 0; i++) {
+    if (used[i] && strcasecmp(devices[i].targetMAC, mac) == 0) slot = i;
+  }
+  portEXIT_CRITICAL(&usedLock);
+  return slot;
+}
+
+JKBMS *BmsRegistry::get(int slot) {
+  if (slot < 0 || slot >= BMS_MAX_DEVICES || !used[slot]) return nullptr;
+  return &devices[slot];
+}
+
+int BmsRegistry::slotOf(const JKBMS *bms) const {
+  int slot = bms - devices;
+  if (slot < 0 || slot >= BMS_MAX_DEVICES || !used[slot]) return -1;
+  return slot;
+}
+
+void BmsRegistry::bindConnHandle(uint16_t connHandle, JKBMS *bms) {
+  int slot = bms - devices;
+  int target = -1;
+  for (int n = 0; n < BMS_HANDLE_MAP_SIZE; n++) {
+    int i = (connHandle + n) & (BMS_HANDLE_MAP_SIZE - 1);
+    if (mapSlot[i] == HANDLE_SLOT_EMPTY) {
+      if (target < 0) target = i;
+      break;
+    }
+    if (mapSlot[i] == HANDLE_SLOT_DELETED) {
+      if (target < 0) target = i;
+      continue;
+    }
+    if (mapHandle[i] == connHandle) {
+      target = i;
+      break;
+    }
+  }
+  if (target < 0) return;  // Cannot happen while the map is larger than the device count
+  mapHandle[target] = connHandle;
+  mapSlot[target] = slot;
+  bms->connHandle = connHandle;
+}
+
+void BmsRegistry::unbindConnHandle(uint16_t connHandle) {
+  for (int n = 0; n < BMS_HANDLE_MAP_SIZE; n++) {
+    int i = (connHandle + n) & (BMS_HANDLE_MAP_SIZE - 1);
+    if (mapSlot[i] == HANDLE_SLOT_EMPTY) return;
+    if (mapSlot[i] >= 0 && mapHandle[i] == connHandle) {
+      mapSlot[i] = HANDLE_SLOT_DELETED;
+      return;
+    }
+  }
+}
+
+JKBMS *BmsRegistry::fromConnHandle(uint16_t connHandle) const {
+  for (int n = 0; n < BMS_HANDLE_MAP_SIZE; n++) {
+    int i = (connHandle + n) & (BMS_HANDLE_MAP_SIZE - 1);
+    if (mapSlot[i] == HANDLE_SLOT_EMPTY) return nullptr;
+    if (mapSlot[i] >= 0 && mapHandle[i] == connHandle) {
+      return const_cast<JKBMS *>(&devices[mapSlot[i]]);
+    }
+  }
+  return nullptr;
+}
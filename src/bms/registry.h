@@ -0,0 +1,61 @@
+#pragma once
+
+#include "jkbms.h"
+#include "../config/config.h"
+
+// Size of the connection handle lookup table, must be a power of two
+// larger than BMS_MAX_DEVICES so probing always finds a free entry
+#define BMS_HANDLE_MAP_SIZE 16
+
+// Returns the transport used by the device in the given slot
+typedef BmsTransport *(*BmsTransportProvider)(int slot);
+
+// Runtime registry of BMS devices.
+// Devices live in fixed slots so every pack costs the same, known amount of
+// memory. Notifications are dispatched through a small hash of connection
+// handles, so lookup cost does not grow with the number of packs.
+class BmsRegistry {
+public:
+  BmsRegistry();
+
+  // Must be set before devices are added
+  void setTransportProvider(BmsTransportProvider provider) { transportProvider = provider; }
+
+  // Adding an existing MAC returns the registered device
+  JKBMS *add(const char *mac);
+  bool remove(const char *mac);
+  JKBMS *find(const char *mac);
+  // Safe from any task, e.g. the NimBLE scan callback. Slot of a registered MAC, or -1
+  int findSlot(const char *mac);
+
+  // Slot access for iteration, returns nullptr for free slots
+  JKBMS *get(int slot);
+  int slotOf(const JKBMS *bms) const;
+  int count() const { return deviceCount; }
+
+  // Connection handle dispatch, BMS task only
+  void bindConnHandle(uint16_t connHandle, JKBMS *bms);
+  void unbindConnHandle(uint16_t connHandle);
+  JKBMS *fromConnHandle(uint16_t connHandle) const;
+
+  // Persist registered MACs in Preferences, see registry_store.cpp
+  void load();
+  void save();
+
+private:
+  JKBMS devices[BMS_MAX_DEVICES];
+  bool used[BMS_MAX_DEVICES];
+  portMUX_TYPE usedLock = portMUX_INITIALIZER_UNLOCKED;  // Guards used[] against findSlot()
+  int deviceCount = 0;
+  BmsTransportProvider transportProvider = nullptr;
+
+  uint16_t mapHandle[BMS_HANDLE_MAP_SIZE];
+  int8_t mapSlot[BMS_HANDLE_MAP_SIZE];
+};
+
+static_assert(BMS_HANDLE_MAP_SIZE > BMS_MAX_DEVICES, "Handle map must be larger than the device count");
+static_assert((BMS_HANDLE_MAP_SIZE & (BMS_HANDLE_MAP_SIZE - 1)) == 0, "Handle map size must be a power of two");
+static_assert(sizeof(JKBMS) <= BMS_DEVICE_MEMORY_BUDGET, "JKBMS exceeds the per-device memory budget");
+
+// Global device registry - defined in registry.cpp
+extern BmsRegistry bmsRegistry;
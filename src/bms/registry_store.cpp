@@ -0,0 +1,47 @@
+#include "registry.h"
+#include "../utils/utils.h"
+#include "prefs.h"
+
+// Load saved MACs, seeding from config.h on first boot
+void BmsRegistry::load() {
+  char key[8];
+  int loaded = 0;
+  for (int i = 0; i < BMS_MAX_DEVICES; i++) {
+    snprintf(key, sizeof(key), "mac%d", i);
+    if (!prefs.isKey(key)) continue;
+    String mac = prefs.getString(key, "");
+    if (mac.length() == 0) continue;
+    add(mac.c_str());
+    loaded++;
+  }
+
+  if (loaded == 0 && !prefs.isKey("macs_saved")) {
+    DEBUG_PRINTLN("No saved BMS devices, using config.h defaults");
+#ifdef BMS_MAC_ADDRESS_1
+    add(BMS_MAC_ADDRESS_1);
+#endif
+#ifdef BMS_MAC_ADDRESS_2
+    add(BMS_MAC_ADDRESS_2);
+#endif
+#ifdef BMS_MAC_ADDRESS_3
+    add(BMS_MAC_ADDRESS_3);
+#endif
+  }
+}
+
+void BmsRegistry::save() {
+  char key[8];
+  int n = 0;
+  for (int i = 0; i < BMS_MAX_DEVICES; i++) {
+    snprintf(key, sizeof(key), "mac%d", i);
+    if (used[i]) {
+      prefs.putString(key, devices[i].targetMAC);
+      n++;
+    } else if (prefs.isKey(key)) {
+      prefs.remove(key);
+    }
+  }
+  // Marks that the list was saved at least once, so an empty list stays empty
+  prefs.putBool("macs_saved", true);
+  DEBUG_PRINTF("Saved %d BMS devices\n", n);
+}
@@ -0,0 +1,76 @@
+#include "telemetry.h"
+#include "../utils/utils.h"
+
+static TelemetryRing rings[TELEMETRY_CONSUMER_COUNT][BMS_MAX_DEVICES];
+static std::atomic<bool> enabled[TELEMETRY_CONSUMER_COUNT];
+
+static inline uint16_t u16le(const uint8_t *p) { return p[0] | p[1] << 8; }
+static inline uint32_t u32le(const uint8_t *p) { return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24; }
+
+// Same offsets as JKBMS::parseData, kept in the protocol's integer units
+void telemetry_sample_from_frame(const uint8_t *frame, int cellCount, TelemetrySample &sample) {
+  if (cellCount > TELEMETRY_MAX_CELLS) cellCount = TELEMETRY_MAX_CELLS;
+  if (cellCount <= 0) {
+    // No settings frame yet: unused cells read 0 mV, so the populated ones come first
+    cellCount = 0;
+    while (cellCount < TELEMETRY_MAX_CELLS && u16le(&frame[6 + cellCount * 2])) cellCount++;
+  }
+
+  sample.cellCount = cellCount;
+  for (int i = 0; i < TELEMETRY_MAX_CELLS; i++) {
+    sample.cellMv[i] = i < cellCount ? u16le(&frame[6 + i * 2]) : 0;
+    sample.wireResMOhm[i] = u16le(&frame[80 + i * 2]);
+  }
+  sample.avgCellMv = u16le(&frame[74]);
+  sample.deltaCellMv = u16le(&frame[76]);
+  sample.mosTempDeciC = (int16_t)u16le(&frame[144]);
+  sample.packMv = u32le(&frame[150]);
+  sample.currentMa = (int32_t)u32le(&frame[158]);
+  sample.t1DeciC = (int16_t)u16le(&frame[162]);
+  sample.t2DeciC = (int16_t)u16le(&frame[164]);
+  sample.soc = frame[173];
+}
+
+void telemetry_publish(int slot, const TelemetrySample &sample) {
+  if (slot < 0 || slot >= BMS_MAX_DEVICES) return;
+  for (int c = 0; c < TELEMETRY_CONSUMER_COUNT; c++) {
+    if (enabled[c].load(std::memory_order_relaxed)) rings[c][slot].push(sample);
+  }
+}
+
+void telemetry_enable(TelemetryConsumer consumer, bool enable) {
+  enabled[consumer].store(enable, std::memory_order_relaxed);
+}
+
+bool telemetry_enabled(TelemetryConsumer consumer) {
+  return enabled[consumer].load(std::memory_order_relaxed);
+}
+
+bool telemetry_pop(TelemetryConsumer consumer, int slot, TelemetrySample &sample) {
+  if (slot < 0 || slot >= BMS_MAX_DEVICES) return false;
+  return rings[consumer][slot].pop(sample);
+}
+
+uint32_t telemetry_overflows(TelemetryConsumer consumer) {
+  uint32_t total = 0;
+  for (int i = 0; i < BMS_MAX_DEVICES; i++) total += rings[consumer][i].overflowCount();
+  return total;
+}
+
+void telemetry_flush(TelemetryConsumer consumer, int slot) {
+  TelemetrySample sample;
+  while (telemetry_pop(consumer, slot, sample)) {}
+}
+
+void telemetry_export_serial() {
+  TelemetrySample s;
+  for (int slot = 0; slot < BMS_MAX_DEVICES; slot++) {
+    while (telemetry_pop(TELEMETRY_EXPORT, slot, s)) {
+      // slot,time,seq,pack mV,current mA,soc,delta mV,cells...
+      Serial.printf("T,%d,%lu,%lu,%lu,%ld,%u,%u", slot, (unsigned long)s.timeMs, (unsigned long)s.seq,
+                    (unsigned long)s.packMv, (long)s.currentMa, s.soc, s.deltaCellMv);
+      for (int i = 0; i < s.cellCount; i++) Serial.printf(",%u", s.cellMv[i]);
+      Serial.println();
+    }
+  }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../config/config.h"
+#include "../utils/spsc_ring.h"
+
+// Decoded telemetry stream
+// Every cell info frame the decoder finishes becomes one compact, integer
+// sample. Each consumer has its own SPSC ring per device slot, so the BMS
+// task publishes without locks and consumers drain at their own pace.
+
+struct TelemetrySample {
+  uint32_t timeMs;                      // millis() when the frame was decoded
+  uint32_t rxUs;                        // micros() when its last notification arrived
+  uint32_t seq;                         // Cell frames decoded for this device
+  uint32_t packMv;
+  int32_t currentMa;                    // Positive while charging
+  uint16_t cellMv[TELEMETRY_MAX_CELLS];
+  uint16_t wireResMOhm[TELEMETRY_MAX_CELLS];
+  uint16_t avgCellMv;
+  uint16_t deltaCellMv;
+  int16_t mosTempDeciC;
+  int16_t t1DeciC;
+  int16_t t2DeciC;
+  uint8_t soc;
+  uint8_t cellCount;
+};
+
+enum TelemetryConsumer {
+  TELEMETRY_UI,
+  TELEMETRY_HISTORY,
+  TELEMETRY_EXPORT,
+  TELEMETRY_CONSUMER_COUNT
+};
+
+typedef SpscRing<TelemetrySample, TELEMETRY_QUEUE_DEPTH> TelemetryRing;
+
+// Fill a sample from a raw, checksum-verified JK02 cell info frame. cellCount
+// comes from the settings frame; 0 takes it from the populated cells instead.
+void telemetry_sample_from_frame(const uint8_t *frame, int cellCount, TelemetrySample &sample);
+
+// Producer side (BMS task). Rings of disabled consumers are skipped.
+void telemetry_publish(int slot, const TelemetrySample &sample);
+
+// Consumer side. Each consumer must only be drained from one task.
+void telemetry_enable(TelemetryConsumer consumer, bool enable);
+bool telemetry_enabled(TelemetryConsumer consumer);
+bool telemetry_pop(TelemetryConsumer consumer, int slot, TelemetrySample &sample);
+uint32_t telemetry_overflows(TelemetryConsumer consumer);
+
+// Drops anything queued for a slot whose device was removed, consumer side
+void telemetry_flush(TelemetryConsumer consumer, int slot);
+
+// Print queued samples as CSV lines, drains TELEMETRY_EXPORT
+void telemetry_export_serial();
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+class JKBMS;
+
+// Thin link between a JKBMS and a BLE stack.
+// The protocol code only talks to this interface, so it runs unchanged on
+// NimBLE (nimble_transport.h) and on the in-process mock (mock_transport.h).
+// Connection state is only changed by the task that owns the device: the
+// caller reports a successful connect with JKBMS::onLinkUp(). NimBLE posts
+// disconnect, MTU and notification events to the BMS task (tasks.h); the
+// mock calls onDisconnected() and handleNotification() directly, host
+// builds are single threaded.
+class BmsTransport {
+public:
+  virtual ~BmsTransport() {}
+
+  void attach(JKBMS *bms) { owner = bms; }
+
+  // Connect to the device and negotiate the MTU. Blocking.
+  virtual bool connect(const char *mac) = 0;
+  // Find the JK characteristic and subscribe to its notifications
+  virtual bool subscribe() = 0;
+  virtual bool write(const uint8_t *data, size_t length) = 0;
+  virtual void disconnect() = 0;
+  // Drop the connection and any stack resources held for the device
+  virtual void release() { disconnect(); }
+  virtual uint16_t mtu() const = 0;
+  // Valid after a successful connect()
+  virtual uint16_t connHandle() const = 0;
+
+protected:
+  JKBMS *owner = nullptr;
+};
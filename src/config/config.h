@@ -1,30 +1,130 @@
 #pragma once
 
-#include <LVGL_CYD.h>
-
 // Screen orientation
-// Takes position of USB connector relative to screen:
-// USB_DOWN  (LV_DISPLAY_ROTATION_0)
-// USB_RIGHT (LV_DISPLAY_ROTATION_90)
-// USB_UP    (LV_DISPLAY_ROTATION_180)
-// USB_LEFT  (LV_DISPLAY_ROTATION_270)
+// Takes position of USB connector relative to screen
+#define USB_DOWN  LV_DISPLAY_ROTATION_0
+#define USB_RIGHT LV_DISPLAY_ROTATION_90
+#define USB_UP    LV_DISPLAY_ROTATION_180
+#define USB_LEFT  LV_DISPLAY_ROTATION_270
 #define SCREEN_ORIENTATION USB_LEFT
 
+// Display driver, see ui/display.h
+// Panel pins and SPI clock are set in configs/cyd/User_Setup.h
+#define DISPLAY_DMA true              // Double buffered DMA flushes, false for one blocking buffer
+#define DISPLAY_BUF_LINES 24          // Lines per draw buffer
+#define DISPLAY_BL_CHANNEL 0          // LEDC channel driving TFT_BL
+#define DISPLAY_BL_FREQ 5000
+#define DISPLAY_BENCHMARK_ON_BOOT false  // Print fps and flush throughput of the main screen at boot
+
+// XPT2046 touch controller, on its own SPI bus (chip select is TOUCH_CS in User_Setup.h)
+#define TOUCH_IRQ 36
+#define TOUCH_SPI_MOSI 32
+#define TOUCH_SPI_MISO 39
+#define TOUCH_SPI_CLK 25
+// Raw readings at the panel edges, swap min and max to invert an axis
+#define TOUCH_X_MIN 200
+#define TOUCH_X_MAX 3700
+#define TOUCH_Y_MIN 240
+#define TOUCH_Y_MAX 3800
+#define TOUCH_POLL_MS 20              // Read interval while the panel is pressed
+#define TOUCH_RELEASE_MS 40           // Contact must be gone this long before a release is reported
+#define TOUCH_JITTER_PX 2             // Smaller moves while pressed are ignored
+
 // BMS Device configuration
-// Add your JK-BMS MAC addresses here
+// Default JK-BMS MAC addresses, used until devices are saved from the scan screen
 #define BMS_MAC_ADDRESS_1 "c8:47:80:23:4f:95"
 // #define BMS_MAC_ADDRESS_2 "20:aa:08:25:26:8b"
 // #define BMS_MAC_ADDRESS_3 "MAC_ADDRESS_3"
 
+// Device registry limits
+#define BMS_MAX_DEVICES 8               // Packs that can be registered at runtime
+#define BMS_DEVICE_MEMORY_BUDGET 1024   // Upper bound for sizeof(JKBMS), checked at compile time
+
 // BLE Scan settings
 #define BLE_SCAN_INTERVAL 100
 #define BLE_SCAN_WINDOW 100
 #define BLE_SCAN_TIME 5000   // Scan for 5 seconds
 #define BLE_SCAN_PERIOD 10000    // Start new scan every 10 seconds if not connected
 
+// Direct connect settings
+// Known MACs are connected by address without waiting for a scan result.
+// Scanning is only used as a fallback once these attempts have failed.
+#define BMS_DIRECT_CONNECT_ATTEMPTS 2
+#define BMS_ADDRESS_TYPE BLE_ADDR_PUBLIC  // JK BMS modules advertise a public address
+
 // BMS connection settings
 #define BMS_CONNECTION_TIMEOUT 20000  // Connection timeout (ms)
-#define BMS_NOTIFY_IGNORE_COUNT 10    // Number of notifications to ignore after parsing
+#define BMS_INIT_COMMAND_DELAY 500    // Between subscribing and each init command (ms)
+#define BLE_PREFERRED_MTU BLE_ATT_MTU_MAX  // Ask for the largest MTU, the BMS answers with what it accepts
+
+// Display refresh
+// New frames redraw the display right away, at most DISPLAY_MAX_FPS times per
+// second; bursts in between are coalesced into the next redraw.
+#define DISPLAY_MAX_FPS 10
+#define DISPLAY_MIN_FRAME_MS (1000 / DISPLAY_MAX_FPS)
+#define DISPLAY_UPDATE_INTERVAL 1000  // Re-check stale data at least this often without new frames
+#define DISPLAY_STALE_TIMEOUT 5000    // Flag shown data as stale when no frame arrived for this long
+#define UI_BENCHMARK_ON_BOOT false    // Time the cell views and font rendering once at boot and print the results
+
+// Screen cache, see ui/screen_cache.h
+#define SCREEN_CACHE_MIN_FREE (24 * 1024)  // Evict cached screens while less heap than this is free
+#define SCREEN_CACHE_BUDGET (40 * 1024)    // Most the cached screens may hold together
+
+// Idle-time screen prebuild, see ui/prebuild.h
+#define PREBUILD_START_DELAY 3000          // Leave boot and the first connections alone (ms)
+#define PREBUILD_INTERVAL 500              // At most one screen per interval (ms)
+#define PREBUILD_COST_GUESS (8 * 1024)     // Room required for a screen never built before
+#define PREBUILD_SLICE_WARN_US 20000       // Log screens that take longer than this to build
+
+// Task layout
+// BLE/protocol work runs on the core NimBLE's host task is pinned to,
+// LVGL rendering and touch get the other core to themselves.
+#define BMS_TASK_CORE 0
+#define BMS_TASK_PRIORITY 3
+#define BMS_TASK_STACK 6144
+#define BMS_TASK_PERIOD 50            // Connection management interval (ms)
+#define CONNECT_TASK_PRIORITY 1       // Blocking NimBLE connects, below the BMS task
+#define CONNECT_TASK_STACK 4096
+#define UI_TASK_CORE 1
+#define UI_TASK_PRIORITY 2
+#define UI_TASK_STACK 8192
+#define UI_TASK_MAX_SLEEP 500         // Longest the UI task sleeps with no LVGL timer due (ms)
+
+// Message queues between the tasks
+#define BMS_NOTIFY_QUEUE_LEN 16       // Notification chunks waiting to be decoded
+#define BMS_NOTIFY_CHUNK_SIZE 244     // Payload per queue item, larger notifications are split
+#define BMS_CONNECT_QUEUE_LEN BMS_MAX_DEVICES  // BMS task -> connect task requests
+#define BMS_LINK_QUEUE_LEN 8          // Connect/disconnect/MTU events, kept apart so notification bursts can't drop them
+#define BMS_CMD_QUEUE_LEN 8           // UI -> BMS task requests
+#define UI_QUEUE_LEN 16               // Deferred UI commands from other tasks
+#define UI_QUEUE_BATCH 16             // Commands applied per UI pass
+
+// Decoded samples queued per device for each telemetry consumer, see bms/telemetry.h
+#define TELEMETRY_QUEUE_DEPTH 8       // Power of two
+#define TELEMETRY_MAX_CELLS 16
+#define TELEMETRY_EXPORT_SERIAL false // Print every decoded sample as a CSV line
+
+#define TASK_STATS_INTERVAL 10000     // Log stack high-watermark and CPU share every 10 s
+#define DIAG_UPDATE_INTERVAL 1000     // Diagnostics screen and overlay refresh, see ui/diagnostics.h
+
+// Backlight idle manager, see ui/idle.h
+#define IDLE_DIM_TIMEOUT 30000        // Dim after this long without touch (ms), 0 never dims
+#define IDLE_DIM_LEVEL 20             // Backlight while dimmed, 0 - 255
+#define IDLE_BLANK_TIMEOUT 300000     // Screen off after this long without touch (ms), 0 never; set on the backlight screen
+#define IDLE_LDR_PIN 34               // CYD light sensor, -1 for boards without one
+#define IDLE_LDR_AUTO false           // Auto brightness at boot
+#define IDLE_LDR_DARK 400             // Raw ADC reading in the dark; the CYD reads 0 in daylight
+#define IDLE_LDR_BRIGHT 0
+#define IDLE_LDR_MIN_LEVEL 10         // Auto brightness never goes below this
+#define IDLE_LDR_INTERVAL 1000        // Light sensor sample period (ms)
 
-// Display update interval
-#define DISPLAY_UPDATE_INTERVAL 3000  // Update display every 3000ms
\ No newline at end of file
+// Alarm engine, see bms/alarms.h. Margins are taken off the pack's own protection settings.
+#define ALARM_CELL_MARGIN_MV 50       // Warn this far before cell OVP/UVP
+#define ALARM_CELL_HYST_MV 20
+#define ALARM_DELTA_MV 100            // Highest - lowest cell
+#define ALARM_DELTA_HYST_MV 20
+#define ALARM_TEMP_MARGIN_DECIC 50    // Warn 5 C before the temperature protections
+#define ALARM_TEMP_HYST_DECIC 20
+#define ALARM_CURRENT_PERCENT 90      // Of the max charge/discharge current
+#define ALARM_CURRENT_HYST_PERCENT 5
+#define ALARM_CHARGING_MA 500         // Above this the pack counts as charging for the temperature rules
@@ -0,0 +1,474 @@
+#include "tasks.h"
+#include <lvgl.h>
+#include "../config/config.h"
+#include "../utils/utils.h"
+#include "../bms/jkbms.h"
+#include "../bms/registry.h"
+#include "../bms/ble_scan.h"
+#include "../bms/telemetry.h"
+#include "../bms/alarms.h"
+#include "../bms/nimble_transport.h"
+#include "../ui/screens.h"
+#include "../ui/ui_queue.h"
+#include "../ui/trends.h"
+#include "../ui/screen_cache.h"
+#include "../ui/display.h"
+#include "../ui/diagnostics.h"
+#include "../ui/idle.h"
+#include "../ui/prebuild.h"
+
+// One queued notification chunk
+struct BmsChunk {
+  uint32_t rxUs;
+  uint16_t connHandle;  // Resolved to a device by the BMS task
+  uint8_t length;
+  uint8_t data[BMS_NOTIFY_CHUNK_SIZE];
+};
+
+static_assert(BMS_NOTIFY_CHUNK_SIZE <= 255, "Chunk length must fit in uint8_t");
+
+// BMS task -> connect task
+struct ConnectRequest {
+  int8_t slot;
+  BmsTransport *transport;
+  char mac[18];
+};
+
+static QueueHandle_t notifyQueue = nullptr;
+static QueueHandle_t linkQueue = nullptr;
+static QueueHandle_t connectQueue = nullptr;
+static QueueHandle_t bmsCmdQueue = nullptr;
+static TaskHandle_t bmsTaskHandle = nullptr;
+static TaskHandle_t connectTaskHandle = nullptr;
+static TaskHandle_t uiTaskHandle = nullptr;
+
+static TaskStats stats[TASK_COUNT] = {
+  { "bms", 0, 0, 0, 0, 0, 0 },
+  { "ui", 0, 0, 0, 0, 0, 0 }
+};
+
+uint32_t notifyQueueOverflows = 0;
+uint32_t linkQueueOverflows = 0;
+static DisplayLatency latency = { 0, 0, 0, 0 };
+
+const DisplayLatency &display_latency() {
+  return latency;
+}
+
+const TaskStats &task_stats(TaskId id) {
+  return stats[id];
+}
+
+// Account time spent working, and close the window every TASK_STATS_INTERVAL
+static void stats_add_work(TaskId id, uint32_t startUs) {
+  uint32_t now = micros();
+  TaskStats &st = stats[id];
+  st.busyUs += now - startUs;
+
+  uint32_t window = now - st.windowStartUs;
+  if (window >= TASK_STATS_INTERVAL * 1000UL) {
+    st.cpuPercent = (uint64_t)st.busyUs * 100 / window;
+    st.stackHighWater = uxTaskGetStackHighWaterMark(NULL);
+    st.wakeupsPerWindow = st.wakeups;
+    st.wakeups = 0;
+    st.busyUs = 0;
+    st.windowStartUs = now;
+  }
+}
+
+bool bms_post_notification(uint16_t connHandle, const uint8_t *data, size_t length) {
+  BmsChunk chunk;
+  chunk.connHandle = connHandle;
+  chunk.rxUs = micros();
+  while (length > 0) {
+    chunk.length = length > BMS_NOTIFY_CHUNK_SIZE ? BMS_NOTIFY_CHUNK_SIZE : length;
+    memcpy(chunk.data, data, chunk.length);
+    if (xQueueSend(notifyQueue, &chunk, 0) != pdTRUE) {
+      notifyQueueOverflows++;
+      return false;
+    }
+    data += chunk.length;
+    length -= chunk.length;
+  }
+  return true;
+}
+
+bool bms_post_link_event(BmsLinkEventType type, int slot, uint16_t value, const uint8_t *address, uint8_t addressType) {
+  BmsLinkEvent event = { type, (int8_t)slot, addressType, value, {} };
+  if (address) memcpy(event.address, address, sizeof(event.address));
+  if (xQueueSend(linkQueue, &event, 0) == pdTRUE) return true;
+  linkQueueOverflows++;
+  return false;
+}
+
+bool bms_post_command(BmsCmdType type, const char *mac) {
+  BmsCmd cmd;
+  cmd.type = type;
+  strlcpy(cmd.mac, mac ? mac : "", sizeof(cmd.mac));
+  return xQueueSend(bmsCmdQueue, &cmd, 0) == pdTRUE;
+}
+
+void ui_wake() {
+  if (uiTaskHandle) xTaskNotifyGive(uiTaskHandle);
+}
+
+void IRAM_ATTR ui_wake_from_isr() {
+  if (!uiTaskHandle) return;
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(uiTaskHandle, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+//********************************************
+// BMS task
+//********************************************
+static unsigned long lastScanTime = 0;
+static bool wasConnected[BMS_MAX_DEVICES] = { false };
+static bool directConnect[BMS_MAX_DEVICES] = { false };  // The pending or running connect is by address, not a scan result
+static bool forgetPending[BMS_MAX_DEVICES] = { false };  // Forgotten while connecting
+
+static void forget_device(const char *mac) {
+  char target[18];
+  strlcpy(target, mac, sizeof(target));  // mac may point into the slot that is cleared
+  JKBMS *bms = bmsRegistry.find(target);
+  int slot = bms ? bmsRegistry.slotOf(bms) : -1;
+  if (!bmsRegistry.remove(target)) return;
+  forgetPending[slot] = false;
+  alarms_reset(slot);
+  alarms_take_changed(slot);  // The slot is gone, DEVICES_CHANGED redraws the banner
+  bmsRegistry.save();
+  ui_post_pack(UI_CMD_DEVICES_CHANGED, slot, nullptr);
+}
+
+static void handle_bms_command(const BmsCmd &cmd) {
+  switch (cmd.type) {
+    case BMS_CMD_ADD_DEVICE: {
+      int before = bmsRegistry.count();
+      JKBMS *bms = bmsRegistry.add(cmd.mac);
+      if (bms) bmsRegistry.save();
+      if (bmsRegistry.count() != before) ui_post_pack(UI_CMD_DEVICES_CHANGED, bmsRegistry.slotOf(bms), bms);
+      break;
+    }
+    case BMS_CMD_FORGET_DEVICE: {
+      // The connect task still uses the transport, remove the device once it reports back
+      JKBMS *bms = bmsRegistry.find(cmd.mac);
+      if (bms && bms->connecting) {
+        forgetPending[bmsRegistry.slotOf(bms)] = true;
+        break;
+      }
+      forget_device(cmd.mac);
+      break;
+    }
+    case BMS_CMD_START_SCAN:
+      scanForDevices();
+      break;
+  }
+}
+
+static void handle_link_event(const BmsLinkEvent &event) {
+  JKBMS *bms = bmsRegistry.get(event.slot);
+  if (!bms) return;
+  switch (event.type) {
+    case BMS_LINK_FOUND: {
+      if (bms->connected || bms->connecting || bms->doConnect) break;
+      DEBUG_PRINTF("Found target device: %s\n", bms->targetMAC);
+      NimBleTransport *transport = nimbleTransportFor(bms);
+      if (transport) transport->scanAddress = NimBLEAddress(event.address, event.addressType);
+      bms->doConnect = true;
+      directConnect[event.slot] = false;
+      pScan->stop();
+      break;
+    }
+    case BMS_LINK_UP:
+    case BMS_LINK_FAILED:
+      bms->connecting = false;
+      if (forgetPending[event.slot]) {
+        forget_device(bms->targetMAC);
+        break;
+      }
+      if (event.type == BMS_LINK_UP) {
+        DEBUG_PRINTF("%s connected successfully\n", bms->targetMAC);
+        bms->onLinkUp(event.value, bms->transport->mtu());
+      } else {
+        DEBUG_PRINTF("%s connection failed\n", bms->targetMAC);
+        // Direct attempts at boot fail quietly when the pack is off, only report scanned devices
+        if (!directConnect[event.slot]) ui_post_alert("Connection failed", bms->targetMAC);
+      }
+      break;
+    case BMS_LINK_DISCONNECTED:
+      // Late events of a client that was already released are ignored
+      if (bms->connected) bms->onDisconnected(event.value);
+      break;
+    case BMS_LINK_MTU:
+      bms->onMtuChanged(event.value);
+      break;
+  }
+}
+
+static void manage_connections() {
+  int connectedCount = 0;
+  bool directPending = false;
+  bool linking = false;
+
+  for (int i = 0; i < BMS_MAX_DEVICES; i++) {
+    JKBMS *bms = bmsRegistry.get(i);
+    if (!bms) continue;
+
+    // Try the known address first, no scan result needed
+    if (bms->wantsDirectConnect()) {
+      bms->directConnectAttempts++;
+      bms->doConnect = true;
+      directConnect[i] = true;
+    }
+
+    // Connect to BMS if needed. The connect task does the blocking part and
+    // reports back with BMS_LINK_UP or BMS_LINK_FAILED. A request that
+    // doesn't fit in the queue stays pending for the next pass.
+    if (bms->doConnect && !bms->connected && !bms->connecting && bms->transport) {
+      DEBUG_PRINTF("Attempting to connect to: %d (%s)...\n", i, bms->targetMAC);
+      ConnectRequest request = { (int8_t)i, bms->transport, "" };
+      strlcpy(request.mac, bms->targetMAC, sizeof(request.mac));
+      if (xQueueSend(connectQueue, &request, 0) == pdTRUE) {
+        bms->connecting = true;
+        bms->doConnect = false;
+      }
+    } else {
+      bms->doConnect = false;
+    }
+
+    if (bms->wantsDirectConnect()) directPending = true;
+    if (bms->connecting || bms->doConnect) linking = true;
+    if (bms->connected) bms->serviceInit();
+
+    // Check for connection timeout
+    if (bms->connected) {
+      connectedCount++;
+      if (millis() - bms->lastNotifyTime > BMS_CONNECTION_TIMEOUT) {
+        DEBUG_PRINTF("%s connection timeout\n", bms->targetMAC);
+        bms->transport->disconnect();
+      }
+    }
+
+    if (bms->connected != wasConnected[i]) {
+      wasConnected[i] = bms->connected;
+      ui_post_pack(UI_CMD_CONNECTION_CHANGED, i, bms);
+      // Stale readings shouldn't keep an alarm up
+      if (!bms->connected) alarms_reset(i);
+      if (alarms_take_changed(i)) ui_post_event(UI_CMD_ALARMS_CHANGED, i);
+    }
+  }
+
+  // Start scan if not all devices are connected and direct connects are exhausted.
+  // Not while connecting: a new scan frees the scan result being connected to.
+  if (connectedCount < bmsRegistry.count() && !directPending && !linking && (millis() - lastScanTime >= BLE_SCAN_PERIOD)) {
+    DEBUG_PRINTLN("Starting scan...");
+    pScan->start(BLE_SCAN_TIME, false, true);
+    lastScanTime = millis();
+  }
+}
+
+static void log_task_stats() {
+  static unsigned long lastLog = 0;
+  if (millis() - lastLog < TASK_STATS_INTERVAL) return;
+  lastLog = millis();
+  for (int i = 0; i < TASK_COUNT; i++) {
+    DEBUG_PRINTF("Task %s: CPU %u%%, stack free %lu bytes, %lu wakeups\n", stats[i].name, stats[i].cpuPercent,
+                 (unsigned long)stats[i].stackHighWater, (unsigned long)stats[i].wakeupsPerWindow);
+  }
+  if (notifyQueueOverflows) DEBUG_PRINTF("Notification queue overflows: %lu\n", (unsigned long)notifyQueueOverflows);
+  if (linkQueueOverflows) DEBUG_PRINTF("Link event queue overflows: %lu\n", (unsigned long)linkQueueOverflows);
+  if (uiQueueOverflows) DEBUG_PRINTF("UI queue overflows: %lu\n", (unsigned long)uiQueueOverflows);
+  if (latency.frames) {
+    DEBUG_PRINTF("Notify to pixels: last %lu us, avg %lu us, max %lu us\n", (unsigned long)latency.lastUs,
+                 (unsigned long)latency.avgUs, (unsigned long)latency.maxUs);
+    latency.maxUs = 0;
+  }
+  for (int c = 0; c < TELEMETRY_CONSUMER_COUNT; c++) {
+    uint32_t dropped = telemetry_overflows((TelemetryConsumer)c);
+    if (dropped) DEBUG_PRINTF("Telemetry consumer %d dropped %lu samples\n", c, (unsigned long)dropped);
+  }
+}
+
+// NimBLE's connect and service discovery block for up to the connect
+// timeout. Only the transport is used here, the result goes back to the
+// BMS task like any other link event.
+static void connect_task(void *param) {
+  for (;;) {
+    ConnectRequest request;
+    if (xQueueReceive(connectQueue, &request, portMAX_DELAY) != pdTRUE) continue;
+    BmsTransport *transport = request.transport;
+    bool ok = transport->connect(request.mac);
+    if (ok && !transport->subscribe()) {
+      DEBUG_PRINTLN("Service or Characteristic not found or unable to subscribe.");
+      transport->disconnect();
+      ok = false;
+    }
+    BmsLinkEvent event = { ok ? BMS_LINK_UP : BMS_LINK_FAILED, request.slot, 0, (uint16_t)(ok ? transport->connHandle() : 0), {} };
+    // May wait, a lost result would leave the device connecting for good
+    xQueueSend(linkQueue, &event, portMAX_DELAY);
+  }
+}
+
+static void bms_task(void *param) {
+  unsigned long lastManage = 0;
+  stats[TASK_BMS].windowStartUs = micros();
+
+  // The UI only learns about packs from their events, starting with the ones loaded at boot
+  for (int i = 0; i < BMS_MAX_DEVICES; i++) {
+    JKBMS *bms = bmsRegistry.get(i);
+    if (bms) ui_post_pack(UI_CMD_DEVICES_CHANGED, i, bms);
+  }
+
+  for (;;) {
+    BmsChunk chunk;
+    // Sleep until a notification arrives, waking for connection management
+    if (xQueueReceive(notifyQueue, &chunk, pdMS_TO_TICKS(BMS_TASK_PERIOD)) == pdTRUE) {
+      uint32_t start = micros();
+      do {
+        // Chunks of a connection that is gone by now resolve to nothing
+        JKBMS *bms = bmsRegistry.fromConnHandle(chunk.connHandle);
+        if (!bms) continue;
+        int slot = bmsRegistry.slotOf(bms);
+        uint32_t frames = bms->framesReceived;
+        bms->lastRxUs = chunk.rxUs;
+        bms->handleNotification(chunk.data, chunk.length);
+        // Nothing to redraw while the UI consumer is off (screen blanked)
+        if (bms->framesReceived != frames && telemetry_enabled(TELEMETRY_UI)) ui_post_pack(UI_CMD_DATA_READY, slot, bms);
+        // Posted even while blanked, a raised alarm wakes the screen
+        if (alarms_take_changed(slot)) ui_post_event(UI_CMD_ALARMS_CHANGED, slot);
+      } while (xQueueReceive(notifyQueue, &chunk, 0) == pdTRUE);
+      stats[TASK_BMS].wakeups++;
+      stats_add_work(TASK_BMS, start);
+    }
+
+    BmsLinkEvent event;
+    while (xQueueReceive(linkQueue, &event, 0) == pdTRUE) handle_link_event(event);
+
+    BmsCmd cmd;
+    while (xQueueReceive(bmsCmdQueue, &cmd, 0) == pdTRUE) handle_bms_command(cmd);
+
+    if (millis() - lastManage >= BMS_TASK_PERIOD) {
+      uint32_t start = micros();
+      manage_connections();
+      lastManage = millis();
+      stats_add_work(TASK_BMS, start);
+    }
+
+    log_task_stats();
+    // CSV lines for TELEMETRY_EXPORT_SERIAL, drained here so the ring doesn't just overflow
+    if (telemetry_enabled(TELEMETRY_EXPORT)) telemetry_export_serial();
+  }
+}
+
+//********************************************
+// UI task
+//********************************************
+static unsigned long lastDisplayUpdate = 0;
+static bool displayDirty = true;
+static uint32_t pendingRxUs = 0;    // Receive time of the newest frame waiting to reach the screen
+
+// Display refresh finished, anything drawn before it is now on the panel
+static void on_refresh_ready(lv_event_t *e) {
+  if (!pendingRxUs) return;
+  uint32_t us = micros() - pendingRxUs;
+  pendingRxUs = 0;
+  latency.lastUs = us;
+  latency.avgUs = latency.frames ? latency.avgUs - latency.avgUs / 8 + us / 8 : us;
+  if (us > latency.maxUs) latency.maxUs = us;
+  latency.frames++;
+}
+
+// Redraws when new data is waiting, no more than DISPLAY_MAX_FPS times a
+// second, plus every DISPLAY_UPDATE_INTERVAL so stale data gets flagged.
+// Returns ms until the next redraw could be due.
+static uint32_t update_display() {
+  unsigned long elapsed = millis() - lastDisplayUpdate;
+  uint32_t wait = displayDirty ? DISPLAY_MIN_FRAME_MS : DISPLAY_UPDATE_INTERVAL;
+  if (elapsed < wait) return wait - elapsed;
+
+  uint32_t rxUs = 0;
+  if (update_bms_display(&rxUs)) {
+    if (rxUs) pendingRxUs = rxUs;
+    // Render in this pass instead of waiting for the refresh timer period
+    lv_timer_ready(lv_display_get_refr_timer(lv_display_get_default()));
+  }
+  lastDisplayUpdate = millis();
+  displayDirty = false;
+  return DISPLAY_MIN_FRAME_MS;
+}
+
+static void ui_task(void *param) {
+  // LVGL is only ever touched from this task
+  ui_init();
+  lv_display_add_event_cb(lv_display_get_default(), on_refresh_ready, LV_EVENT_REFR_READY, NULL);
+  stats[TASK_UI].windowStartUs = micros();
+
+  for (;;) {
+    uint32_t start = micros();
+
+    // A tap on the blank screen only turns it back on
+    if (idle_blanked() && display_touch_pending()) {
+      display_touch_swallow();
+      idle_wake();
+      displayDirty = true;
+    }
+
+    if (ui_queue_drain() | ui_telemetry_drain()) displayDirty = true;
+    trends_drain();
+
+    // Update widgets first so the LVGL pass below already renders them, then
+    // sleep until the nearest LVGL timer or display deadline, or until
+    // another task wakes us with new work. Blanked, only touch and the
+    // queues are served; history keeps being recorded by trends_drain().
+    uint32_t displayMs = UINT32_MAX;
+    if (!idle_blanked()) {
+      diagnostics_update();
+      displayMs = update_display();
+    }
+    uint32_t touchMs = display_touch_service();
+    uint32_t sleepMs = lv_timer_handler();
+    // Navigation in the pass above may have left screens to evict
+    screen_cache_service();
+    uint32_t idleMs = idle_service();
+    // Builds one screen at most, after this pass has rendered, and never while touched
+    uint32_t prebuildMs = prebuild_service(displayDirty || touchMs != UINT32_MAX || display_touch_pending());
+    if (displayMs < sleepMs) sleepMs = displayMs;
+    if (touchMs < sleepMs) sleepMs = touchMs;
+    if (idleMs < sleepMs) sleepMs = idleMs;
+    if (prebuildMs < sleepMs) sleepMs = prebuildMs;
+    if (sleepMs > UI_TASK_MAX_SLEEP) sleepMs = UI_TASK_MAX_SLEEP;
+
+    // LVGL memory can only be inspected from this task
+    static unsigned long lastMemReport = 0;
+    if (millis() - lastMemReport >= TASK_STATS_INTERVAL) {
+      lastMemReport = millis();
+      screen_cache_report();
+      const TouchStats &touch = display_touch_stats();
+      if (touch.presses) {
+        DEBUG_PRINTF("Touch: %lu presses, %lu reads, response last %lu us, avg %lu us, max %lu us\n",
+                     (unsigned long)touch.presses, (unsigned long)touch.reads, (unsigned long)touch.lastLatencyUs,
+                     (unsigned long)touch.avgLatencyUs, (unsigned long)touch.maxLatencyUs);
+      }
+    }
+
+    stats_add_work(TASK_UI, start);
+    stats[TASK_UI].wakeups++;
+    if (sleepMs > 0) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sleepMs));
+  }
+}
+
+void tasks_start() {
+  notifyQueue = xQueueCreate(BMS_NOTIFY_QUEUE_LEN, sizeof(BmsChunk));
+  linkQueue = xQueueCreate(BMS_LINK_QUEUE_LEN, sizeof(BmsLinkEvent));
+  connectQueue = xQueueCreate(BMS_CONNECT_QUEUE_LEN, sizeof(ConnectRequest));
+  bmsCmdQueue = xQueueCreate(BMS_CMD_QUEUE_LEN, sizeof(BmsCmd));
+  ui_queue_init();
+  telemetry_enable(TELEMETRY_UI, true);
+  telemetry_enable(TELEMETRY_HISTORY, true);
+  telemetry_enable(TELEMETRY_EXPORT, TELEMETRY_EXPORT_SERIAL);
+
+  xTaskCreatePinnedToCore(ui_task, "ui", UI_TASK_STACK, nullptr, UI_TASK_PRIORITY, &uiTaskHandle, UI_TASK_CORE);
+  xTaskCreatePinnedToCore(bms_task, "bms", BMS_TASK_STACK, nullptr, BMS_TASK_PRIORITY, &bmsTaskHandle, BMS_TASK_CORE);
+  xTaskCreatePinnedToCore(connect_task, "connect", CONNECT_TASK_STACK, nullptr, CONNECT_TASK_PRIORITY, &connectTaskHandle,
+                          BMS_TASK_CORE);
+}
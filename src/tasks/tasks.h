@@ -0,0 +1,88 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Task layout
+// - BMS task (BMS_TASK_CORE): owns the device registry, connection state
+//   machines and frame decoding. NimBLE callbacks only copy notification
+//   bytes and link events into its queues.
+// - Connect task (BMS_TASK_CORE, lower priority): runs the blocking NimBLE
+//   connect and service discovery the BMS task asks for, so decoding of the
+//   other packs goes on meanwhile, and reports back with a link event.
+// - UI task (UI_TASK_CORE): owns LVGL rendering and touch input.
+// The tasks only talk through the bounded queues below, the UI command
+// queue in ui/ui_queue.h and the telemetry rings. The UI task never reads
+// a JKBMS, pack events carry a copy of what it shows.
+
+// Requests from the UI to the BMS task
+enum BmsCmdType {
+  BMS_CMD_ADD_DEVICE,
+  BMS_CMD_FORGET_DEVICE,
+  BMS_CMD_START_SCAN
+};
+
+struct BmsCmd {
+  BmsCmdType type;
+  char mac[18];
+};
+
+// NimBLE host task and connect task -> BMS task. Only the BMS task changes
+// JKBMS connection state and the registry's connection handle map.
+enum BmsLinkEventType {
+  BMS_LINK_FOUND,         // The scan saw the registered device in slot; address is its advertised address
+  BMS_LINK_UP,            // Connected and subscribed, value: connection handle
+  BMS_LINK_FAILED,        // The connect or subscribe failed
+  BMS_LINK_DISCONNECTED,  // value: reason
+  BMS_LINK_MTU            // value: negotiated MTU
+};
+
+// Scan results are freed by the next scan, so only a copy of the address travels
+struct BmsLinkEvent {
+  BmsLinkEventType type;
+  int8_t slot;
+  uint8_t addressType;
+  uint16_t value;
+  uint8_t address[6];
+};
+
+// Per-task load figures, refreshed every TASK_STATS_INTERVAL
+struct TaskStats {
+  const char *name;
+  uint32_t stackHighWater;    // Lowest free stack seen, bytes
+  uint8_t cpuPercent;         // Share of one core spent working in the last window
+  uint32_t wakeupsPerWindow;  // Loop iterations in the last window
+  uint32_t busyUs;
+  uint32_t windowStartUs;
+  uint32_t wakeups;
+};
+
+// Time from a frame's last BLE notification to the end of the display
+// refresh that showed it
+struct DisplayLatency {
+  uint32_t lastUs;
+  uint32_t avgUs;             // Moving average over roughly the last 8 frames
+  uint32_t maxUs;             // Since the last stats log
+  uint32_t frames;            // Frames that reached the screen
+};
+
+enum TaskId {
+  TASK_BMS,
+  TASK_UI,
+  TASK_COUNT
+};
+
+void tasks_start();
+
+// Safe to call from NimBLE callbacks, never blocks. Returns false when the queue is full.
+bool bms_post_notification(uint16_t connHandle, const uint8_t *data, size_t length);
+bool bms_post_link_event(BmsLinkEventType type, int slot, uint16_t value = 0, const uint8_t *address = nullptr,
+                         uint8_t addressType = 0);
+bool bms_post_command(BmsCmdType type, const char *mac = nullptr);
+// Wake the UI task before its next LVGL deadline, e.g. from a touch callback
+void ui_wake();
+void ui_wake_from_isr();
+
+const TaskStats &task_stats(TaskId id);
+const DisplayLatency &display_latency();
+extern uint32_t notifyQueueOverflows;
+extern uint32_t linkQueueOverflows;
@@ -0,0 +1,74 @@
+#include "alarm_banner.h"
+#include "idle.h"
+#include "theme.h"
+#include "ui_queue.h"
+#include "../config/config.h"
+#include "../utils/utils.h"
+#include "../utils/fixed_fmt.h"
+#include "../bms/alarms.h"
+
+static lv_obj_t *banner = nullptr;    // Top layer, survives the screen
+static lv_obj_t *lbl_banner = nullptr;
+static FixedText<48 * BMS_MAX_DEVICES> bannerText;
+static uint32_t shown[BMS_MAX_DEVICES] = { 0 };   // Alarm sets at the last update
+static bool acknowledged = false;
+
+static void create_banner() {
+  banner = lv_obj_create(lv_layer_top());
+  lv_obj_add_style(banner, &style_alarm, LV_PART_MAIN);
+  lv_obj_set_width(banner, lv_pct(100));
+  lv_obj_set_height(banner, LV_SIZE_CONTENT);
+  lv_obj_align(banner, LV_ALIGN_TOP_MID, 0, 0);
+  lv_obj_clear_flag(banner, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_add_flag(banner, LV_OBJ_FLAG_HIDDEN);
+  lv_obj_add_event_cb(banner, [](lv_event_t *e) -> void {
+    acknowledged = true;
+    lv_obj_add_flag(banner, LV_OBJ_FLAG_HIDDEN);
+  }, LV_EVENT_CLICKED, NULL);
+
+  lbl_banner = lv_label_create(banner);
+  lv_obj_set_width(lbl_banner, lv_pct(100));  // Wraps, the default long mode
+}
+
+// "Pack 1: Cell high (12), Temp high"
+static void add_pack(int slot, uint32_t active) {
+  if (bannerText.len) bannerText.add("\n");
+  bannerText.add(LV_SYMBOL_WARNING " Pack ").add(slot + 1).add(":");
+  const char *sep = " ";
+  for (int id = 0; id < ALARM_COUNT; id++) {
+    if (!(active & ALARM_BIT(id))) continue;
+    bannerText.add(sep).add(alarms_name((AlarmId)id));
+    uint8_t cell = id == ALARM_CELL_HIGH ? alarms_high_cell(slot) : id == ALARM_CELL_LOW ? alarms_low_cell(slot) : 0;
+    if (cell) bannerText.add(" (").add(cell).add(")");
+    sep = ", ";
+  }
+}
+
+void alarm_banner_update() {
+  if (!banner) create_banner();
+
+  bool raised = false;
+  bannerText.clear();
+  for (int slot = 0; slot < BMS_MAX_DEVICES; slot++) {
+    // A freed slot may still hold the old pack's alarms until it is reset
+    uint32_t active = ui_pack(slot) ? alarms_active(slot) : 0;
+    if (active & ~shown[slot]) raised = true;
+    shown[slot] = active;
+    if (active) add_pack(slot, active);
+  }
+
+  if (!bannerText.len) {
+    acknowledged = false;
+    lv_obj_add_flag(banner, LV_OBJ_FLAG_HIDDEN);
+    return;
+  }
+  lv_label_set_text_static(lbl_banner, bannerText.c_str());
+  // Cleared alarms only update the text, new ones bring the banner back
+  if (raised) {
+    DEBUG_PRINTF("Alarm: %s\n", bannerText.c_str());
+    acknowledged = false;
+    idle_wake();
+    lv_timer_ready(lv_display_get_refr_timer(NULL));
+  }
+  if (!acknowledged) lv_obj_clear_flag(banner, LV_OBJ_FLAG_HIDDEN);
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <lvgl.h>
+
+// Alarm banner
+// Lists the active alarms of every pack (see bms/alarms.h) in a strip on
+// lv_layer_top(), so it stays up across screen changes. A newly raised alarm
+// wakes a dimmed or blanked screen and forces the next refresh, so the banner
+// is on the panel within one frame of the UI task draining the event.
+// Tapping the banner hides it until another alarm is raised.
+
+// UI task. Re-reads the alarm sets, called for UI_CMD_ALARMS_CHANGED and UI_CMD_DEVICES_CHANGED.
+void alarm_banner_update();
@@ -0,0 +1,230 @@
+#include "cell_bars.h"
+#include "fonts.h"
+#include "../utils/utils.h"
+#include "../utils/fixed_fmt.h"
+
+#define CELL_BARS_GAP 6          // Space between columns, px
+#define CELL_BARS_SCALE_STEP 10  // Scale ends snap to this many units so they rarely move
+#define VALUE_NONE 0xFFFF
+
+struct CellBars {
+  uint8_t count;
+  uint8_t lowIdx;
+  uint8_t highIdx;
+  uint16_t values[CELL_BARS_MAX];
+  int32_t scaleLo;
+  int32_t scaleHi;
+
+  // Glyph metrics, measured once at creation
+  const lv_font_t *font;
+  int32_t rowHeight;
+  int32_t indexWidth;
+  int32_t valueWidth;
+};
+
+static void row_area(lv_obj_t *obj, const CellBars *bars, int row, lv_area_t *area) {
+  lv_obj_get_content_coords(obj, area);
+  area->y1 += row * bars->rowHeight;
+  area->y2 = area->y1 + bars->rowHeight - 1;
+}
+
+static void draw_cb(lv_event_t *e) {
+  lv_obj_t *obj = lv_event_get_target_obj(e);
+  CellBars *bars = static_cast<CellBars *>(lv_event_get_user_data(e));
+  lv_layer_t *layer = lv_event_get_layer(e);
+
+  lv_draw_label_dsc_t label;
+  lv_draw_label_dsc_init(&label);
+  label.font = bars->font;
+  label.color = lv_color_black();
+  label.text_local = 1;  // Row text lives on this stack frame
+
+  lv_draw_rect_dsc_t track;
+  lv_draw_rect_dsc_init(&track);
+  track.bg_color = lv_color_hex(0xE0E0E0);
+  track.radius = 2;
+
+  lv_draw_rect_dsc_t fill;
+  lv_draw_rect_dsc_init(&fill);
+  fill.radius = 2;
+
+  int32_t span = bars->scaleHi - bars->scaleLo;
+  char text[8];
+
+  for (int i = 0; i < bars->count; i++) {
+    lv_area_t row;
+    row_area(obj, bars, i, &row);
+
+    lv_area_t cell = row;
+    cell.x2 = cell.x1 + bars->indexWidth - 1;
+    text[0] = '0' + (i + 1) / 10;
+    text[1] = '0' + (i + 1) % 10;
+    text[2] = 0;
+    label.text = text;
+    label.align = LV_TEXT_ALIGN_RIGHT;
+    lv_draw_label(layer, &label, &cell);
+
+    lv_area_t value = row;
+    value.x1 = value.x2 - bars->valueWidth + 1;
+    uint16_t v = bars->values[i];
+    if (v == VALUE_NONE) {
+      text[0] = '-';
+      text[1] = 0;
+    } else {
+      fixed_format(text, sizeof(text), v, 3, 3);
+    }
+    label.text = text;
+    lv_draw_label(layer, &label, &value);
+
+    // Bar track with a fill scaled between the current low and high
+    lv_area_t bar = row;
+    bar.x1 += bars->indexWidth + CELL_BARS_GAP;
+    bar.x2 = value.x1 - CELL_BARS_GAP;
+    bar.y1 += 2;
+    bar.y2 -= 2;
+    if (bar.x2 <= bar.x1) continue;
+    lv_draw_rect(layer, &track, &bar);
+
+    if (v == VALUE_NONE || span <= 0) continue;
+    int32_t width = lv_area_get_width(&bar);
+    int32_t len = (int32_t)(v - bars->scaleLo) * width / span;
+    if (len < 2) len = 2;
+    if (len > width) len = width;
+    bar.x2 = bar.x1 + len - 1;
+    if (i == bars->highIdx) fill.bg_color = lv_palette_main(LV_PALETTE_RED);
+    else if (i == bars->lowIdx) fill.bg_color = lv_palette_main(LV_PALETTE_BLUE);
+    else fill.bg_color = lv_palette_main(LV_PALETTE_GREEN);
+    lv_draw_rect(layer, &fill, &bar);
+  }
+}
+
+static void delete_cb(lv_event_t *e) {
+  delete static_cast<CellBars *>(lv_event_get_user_data(e));
+}
+
+lv_obj_t *cell_bars_create(lv_obj_t *parent, uint8_t count) {
+  CellBars *bars = new CellBars();
+  bars->count = count > CELL_BARS_MAX ? CELL_BARS_MAX : count;
+  for (int i = 0; i < CELL_BARS_MAX; i++) bars->values[i] = VALUE_NONE;
+  bars->lowIdx = bars->highIdx = 0xFF;
+
+  // Fixed-width columns from the digit advance, so drawing never measures text
+  bars->font = FONT_BODY;
+  int32_t digit = lv_font_get_glyph_width(bars->font, '0', '0');
+  bars->rowHeight = lv_font_get_line_height(bars->font) + 2;
+  bars->indexWidth = digit * 2;
+  bars->valueWidth = digit * 5 + lv_font_get_glyph_width(bars->font, '.', '0');
+
+  lv_obj_t *obj = lv_obj_create(parent);
+  lv_obj_remove_style_all(obj);
+  lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE);
+  lv_obj_set_size(obj, lv_pct(100), bars->count * bars->rowHeight);
+  lv_obj_add_event_cb(obj, draw_cb, LV_EVENT_DRAW_MAIN, bars);
+  lv_obj_add_event_cb(obj, delete_cb, LV_EVENT_DELETE, bars);
+  lv_obj_set_user_data(obj, bars);
+  return obj;
+}
+
+bool cell_bars_set_values(lv_obj_t *obj, const uint16_t *values, uint8_t count) {
+  CellBars *bars = static_cast<CellBars *>(lv_obj_get_user_data(obj));
+  if (count > CELL_BARS_MAX) count = CELL_BARS_MAX;
+
+  bool all = false;
+  if (count != bars->count) {
+    bars->count = count;
+    lv_obj_set_height(obj, count * bars->rowHeight);
+    all = true;
+  }
+
+  // Snapped scale and the low/high markers; if either moves every bar changes
+  int32_t lo = INT32_MAX, hi = -1;
+  uint8_t lowIdx = 0xFF, highIdx = 0xFF;
+  for (int i = 0; values && i < count; i++) {
+    if (values[i] < lo) { lo = values[i]; lowIdx = i; }
+    if (values[i] > hi) { hi = values[i]; highIdx = i; }
+  }
+  int32_t scaleLo = 0, scaleHi = 0;
+  if (values && count > 0) {
+    scaleLo = (lo / CELL_BARS_SCALE_STEP - 1) * CELL_BARS_SCALE_STEP;
+    scaleHi = (hi / CELL_BARS_SCALE_STEP + 1) * CELL_BARS_SCALE_STEP;
+  }
+  if (scaleLo != bars->scaleLo || scaleHi != bars->scaleHi) {
+    bars->scaleLo = scaleLo;
+    bars->scaleHi = scaleHi;
+    all = true;
+  }
+
+  uint8_t oldLow = bars->lowIdx, oldHigh = bars->highIdx;
+  bars->lowIdx = lowIdx;
+  bars->highIdx = highIdx;
+
+  bool markersMoved = oldLow != lowIdx || oldHigh != highIdx;
+  bool any = all;
+  for (int i = 0; i < count; i++) {
+    uint16_t v = values ? values[i] : VALUE_NONE;
+    bool marker = markersMoved && (i == oldLow || i == oldHigh || i == lowIdx || i == highIdx);
+    if (v == bars->values[i] && !marker) continue;
+    bars->values[i] = v;
+    any = true;
+    if (!all) {
+      lv_area_t area;
+      row_area(obj, bars, i, &area);
+      lv_obj_invalidate_area(obj, &area);
+    }
+  }
+
+  if (all) lv_obj_invalidate(obj);
+  return any;
+}
+
+void cell_bars_benchmark(int iterations) {
+  if (iterations <= 0) return;
+  lv_obj_t *previous = lv_screen_active();
+  lv_obj_t *scratch = lv_obj_create(NULL);
+  lv_screen_load(scratch);
+
+  uint16_t values[16];
+  uint32_t seed = 1;
+  auto next_values = [&]() {
+    for (int c = 0; c < 16; c++) {
+      seed = seed * 1103515245 + 12345;
+      values[c] = 3300 + (seed >> 16) % 40;
+    }
+  };
+
+  // Same shape as the cell voltage table in go_cell_voltages()
+  lv_obj_t *table = lv_table_create(scratch);
+  lv_table_set_column_count(table, 2);
+  lv_table_set_row_count(table, 17);
+  lv_table_set_column_width(table, 0, 80);
+  lv_table_set_column_width(table, 1, 100);
+  lv_obj_set_style_text_font(table, FONT_BODY, LV_PART_ITEMS);
+  for (int i = 1; i <= 16; i++) lv_table_set_cell_value_fmt(table, i, 0, "%d", i);
+  lv_refr_now(NULL);
+
+  uint32_t start = micros();
+  for (int n = 0; n < iterations; n++) {
+    next_values();
+    for (int i = 0; i < 16; i++) lv_table_set_cell_value_fmt(table, i + 1, 1, "%u.%03u", values[i] / 1000, values[i] % 1000);
+    lv_refr_now(NULL);
+  }
+  uint32_t tableUs = (micros() - start) / iterations;
+  lv_obj_delete(table);
+
+  lv_obj_t *bars = cell_bars_create(scratch, 16);
+  lv_refr_now(NULL);
+  seed = 1;
+  start = micros();
+  for (int n = 0; n < iterations; n++) {
+    next_values();
+    cell_bars_set_values(bars, values, 16);
+    lv_refr_now(NULL);
+  }
+  uint32_t barsUs = (micros() - start) / iterations;
+
+  lv_screen_load(previous);
+  lv_obj_delete(scratch);
+  DEBUG_PRINTF("Cell view update + refresh: lv_table %lu us, cell bars %lu us (%d runs)\n",
+               (unsigned long)tableUs, (unsigned long)barsUs, iterations);
+}
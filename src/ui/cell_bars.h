@@ -0,0 +1,23 @@
+#pragma once
+
+#include <lvgl.h>
+
+// Cell bar widget
+// Draws one row per cell: index, a bar scaled between the lowest and
+// highest value, and the value as text. Values are integer thousandths
+// (mV, mOhm). Rows are drawn straight from the integer data in
+// LV_EVENT_DRAW_MAIN, and an update only invalidates the rows whose value
+// changed. That is much cheaper than a 17-row lv_table, which re-lays out
+// text and invalidates the whole table on every cell write.
+
+#define CELL_BARS_MAX 32
+
+lv_obj_t *cell_bars_create(lv_obj_t *parent, uint8_t count);
+
+// Pass values == nullptr to show placeholders, e.g. while disconnected.
+// Returns true if anything will be redrawn.
+bool cell_bars_set_values(lv_obj_t *obj, const uint16_t *values, uint8_t count);
+
+// Times updates + full refreshes of a 16-row lv_table against the bar
+// widget on a scratch screen and prints the results
+void cell_bars_benchmark(int iterations);
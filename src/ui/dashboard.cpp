@@ -0,0 +1,189 @@
+#include "dashboard.h"
+#include "ui_queue.h"
+#include "theme.h"
+#include "../config/config.h"
+#include "../utils/utils.h"
+#include "../utils/fixed_fmt.h"
+
+#define SHOWN_UNKNOWN INT32_MIN  // Widget text not known yet, always write
+
+struct DevicePanel {
+  lv_obj_t *tile;
+  int8_t slot;
+  bool built;
+  lv_obj_t *name_label;
+  lv_obj_t *gauge;
+  lv_obj_t *gauge_label;
+  lv_obj_t *va_label;
+  lv_obj_t *stats_label;
+  int32_t shownConnected;
+  int32_t shownSoc;
+  int32_t shownPackMv;
+  int32_t shownCurrentMa;
+  int32_t shownSeq;
+  // Label text, shown with lv_label_set_text_static() so LVGL neither
+  // formats nor copies it
+  FixedText<8> socText;
+  FixedText<32> vaText;
+  FixedText<48> statsText;
+};
+
+static lv_obj_t *tileview = nullptr;
+static DevicePanel panels[BMS_MAX_DEVICES];
+static int panelCount = 0;
+static int activePanel = -1;
+
+static void build_panel(DevicePanel &p, int index) {
+  lv_obj_set_layout(p.tile, LV_LAYOUT_FLEX);
+  lv_obj_set_flex_flow(p.tile, LV_FLEX_FLOW_COLUMN);
+  lv_obj_set_flex_align(p.tile, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+  lv_obj_add_style(p.tile, &style_pad_row_tight, LV_PART_MAIN);
+
+  // Position in the carousel and which pack this is
+  const UiPackInfo *pack = ui_pack(p.slot);
+  p.name_label = lv_label_create(p.tile);
+  lv_obj_add_style(p.name_label, &style_text_small, LV_PART_MAIN);
+  lv_label_set_text_fmt(p.name_label, "%d/%d  %s", index + 1, panelCount, pack ? pack->mac : "");
+
+  p.gauge = lv_arc_create(p.tile);
+  lv_arc_set_range(p.gauge, 0, 100);
+  lv_obj_set_size(p.gauge, 120, 120);
+  lv_arc_set_rotation(p.gauge, 135);
+  lv_arc_set_bg_angles(p.gauge, 0, 270);
+
+  // Make arc read-only, and let swipes through to the tileview
+  lv_obj_clear_flag(p.gauge, LV_OBJ_FLAG_CLICKABLE);
+  lv_obj_add_style(p.gauge, &style_knob_hidden, LV_PART_KNOB);
+
+  p.gauge_label = lv_label_create(p.gauge);
+  lv_obj_add_style(p.gauge_label, &style_text_large, LV_PART_MAIN);
+  lv_obj_center(p.gauge_label);
+
+  p.va_label = lv_label_create(p.tile);
+  lv_obj_add_style(p.va_label, &style_text_value, LV_PART_MAIN);
+
+  p.stats_label = lv_label_create(p.tile);
+  lv_obj_add_style(p.stats_label, &style_text_small, LV_PART_MAIN);
+
+  p.shownConnected = p.shownSoc = p.shownPackMv = p.shownCurrentMa = p.shownSeq = SHOWN_UNKNOWN;
+  p.built = true;
+}
+
+static void show_panel(int index) {
+  if (index < 0 || index >= panelCount) return;
+  activePanel = index;
+  if (!panels[index].built) build_panel(panels[index], index);
+  dashboard_update();
+}
+
+static void on_tile_changed(lv_event_t *e) {
+  lv_obj_t *tile = lv_tileview_get_tile_active(tileview);
+  for (int i = 0; i < panelCount; i++) {
+    if (panels[i].tile == tile) {
+      show_panel(i);
+      return;
+    }
+  }
+}
+
+void dashboard_create(lv_obj_t *parent) {
+  tileview = lv_tileview_create(parent);
+  lv_obj_set_width(tileview, lv_pct(100));
+  lv_obj_set_flex_grow(tileview, 1);
+  lv_obj_add_style(tileview, &style_transparent, LV_PART_MAIN);
+  lv_obj_set_scrollbar_mode(tileview, LV_SCROLLBAR_MODE_OFF);
+  lv_obj_add_event_cb(tileview, on_tile_changed, LV_EVENT_VALUE_CHANGED, NULL);
+  dashboard_sync();
+}
+
+void dashboard_sync() {
+  if (!tileview) return;
+  int selected = dashboard_selected_slot();
+
+  // Tiles are cheap placeholders, rebuilding them keeps the columns contiguous
+  lv_obj_clean(tileview);
+  panelCount = 0;
+  activePanel = -1;
+  int restore = 0;
+
+  for (int slot = 0; slot < BMS_MAX_DEVICES; slot++) {
+    if (!ui_pack(slot)) continue;
+    DevicePanel &p = panels[panelCount];
+    p = DevicePanel();
+    p.tile = lv_tileview_add_tile(tileview, panelCount, 0, LV_DIR_HOR);
+    p.slot = slot;
+    if (slot == selected) restore = panelCount;
+    panelCount++;
+  }
+
+  if (panelCount == 0) {
+    lv_obj_t *tile = lv_tileview_add_tile(tileview, 0, 0, LV_DIR_NONE);
+    lv_obj_t *lbl = lv_label_create(tile);
+    lv_label_set_text(lbl, "No BMS saved.\nMore > Scan devices");
+    lv_obj_center(lbl);
+    return;
+  }
+
+  lv_tileview_set_tile_by_index(tileview, restore, 0, LV_ANIM_OFF);
+  show_panel(restore);
+}
+
+bool dashboard_update() {
+  if (activePanel < 0) return false;
+  DevicePanel &p = panels[activePanel];
+  if (!p.built) return false;
+
+  const UiPackInfo *pack = ui_pack(p.slot);
+  bool connected = pack && pack->connected;
+  const TelemetrySample *sample = connected ? ui_sample(p.slot) : nullptr;
+  bool changed = false;
+
+  if (p.shownConnected != connected) {
+    p.shownConnected = connected;
+    lv_obj_set_style_text_color(p.name_label, connected ? lv_color_black() : lv_palette_main(LV_PALETTE_GREY), LV_PART_MAIN);
+    changed = true;
+  }
+
+  int32_t soc = sample ? sample->soc : 0;
+  if (p.shownSoc != soc) {
+    p.shownSoc = soc;
+    lv_arc_set_value(p.gauge, soc);
+    lv_label_set_text_static(p.gauge_label, p.socText.clear().add(soc).add("%").c_str());
+    changed = true;
+  }
+
+  int32_t packMv = sample ? (int32_t)sample->packMv : -1;
+  int32_t currentMa = sample ? sample->currentMa : INT32_MAX;
+  if (p.shownPackMv != packMv || p.shownCurrentMa != currentMa) {
+    p.shownPackMv = packMv;
+    p.shownCurrentMa = currentMa;
+    if (sample) {
+      p.vaText.clear().add("V: ").add(packMv, 3, 2).add("   A: ").add(currentMa, 3, 3);
+      lv_label_set_text_static(p.va_label, p.vaText.c_str());
+    } else {
+      lv_label_set_text_static(p.va_label, "V: --.--   A: ---.---");
+    }
+    changed = true;
+  }
+
+  // Secondary line changes with nearly every frame, key it on the sample
+  int32_t seq = sample ? (int32_t)sample->seq : -1;
+  if (p.shownSeq != seq) {
+    p.shownSeq = seq;
+    if (sample) {
+      p.statsText.clear().add("Delta ").add(sample->deltaCellMv).add(" mV   T1 ").add(sample->t1DeciC, 1, 1);
+      p.statsText.add("C   MOS ").add(sample->mosTempDeciC, 1, 1).add("C");
+      lv_label_set_text_static(p.stats_label, p.statsText.c_str());
+    } else {
+      lv_label_set_text_static(p.stats_label, connected ? "Waiting for data..." : "Not connected");
+    }
+    changed = true;
+  }
+
+  return changed;
+}
+
+int dashboard_selected_slot() {
+  if (activePanel < 0 || activePanel >= panelCount) return -1;
+  return panels[activePanel].slot;
+}
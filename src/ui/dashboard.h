@@ -0,0 +1,20 @@
+#pragma once
+
+#include <lvgl.h>
+
+// Main screen carousel
+// One swipeable tile per registered BMS. A tile is an empty placeholder
+// until it is first swiped to; only then are its gauge and labels built,
+// and only the tile on screen is ever updated, so more packs don't add
+// render work.
+
+void dashboard_create(lv_obj_t *parent);
+
+// Rebuild the tile list after devices were added or removed
+void dashboard_sync();
+
+// Update the visible tile. Returns true if any widget changed.
+bool dashboard_update();
+
+// Registry slot of the device on the visible tile, -1 if none
+int dashboard_selected_slot();
@@ -0,0 +1,161 @@
+#include "diagnostics.h"
+#include "screens.h"
+#include "navigation.h"
+#include "display.h"
+#include "screen_cache.h"
+#include "theme.h"
+#include "ui_queue.h"
+#include "../config/config.h"
+#include "../utils/utils.h"
+#include "../tasks/tasks.h"
+
+lv_obj_t *scr_diagnostics = nullptr;
+static lv_obj_t *diag_table = nullptr;
+static lv_obj_t *lbl_overlay = nullptr;   // Top layer, survives the screen
+static bool overlayEnabled = false;
+
+enum DiagRow {
+  ROW_FPS,
+  ROW_REFRESH,
+  ROW_FLUSH,
+  ROW_LVGL_MEM,
+  ROW_HEAP,
+  ROW_HEAP_MIN,
+  ROW_STACK,
+  ROW_CPU,
+  ROW_TOUCH,
+  ROW_PACKS       // One row per registered pack from here on
+};
+
+// Counter values at the previous update, for per-second rates
+static unsigned long lastUpdate = 0;
+static bool updateNow = false;    // Fill on the next pass, without waiting out the interval
+static uint32_t lastRefreshes = 0;
+static uint64_t lastRefreshUs = 0;
+static uint64_t lastFlushUs = 0;
+static uint32_t lastFrames[BMS_MAX_DEVICES] = { 0 };
+
+static void set_row(int row, const char *name, const char *fmt, ...) {
+  char buf[40];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  lv_table_set_cell_value(diag_table, row, 0, name);
+  lv_table_set_cell_value(diag_table, row, 1, buf);
+}
+
+void diagnostics_on_evict() {
+  diag_table = nullptr;
+}
+
+static void update_overlay(uint32_t fps10) {
+  if (!lbl_overlay) {
+    lbl_overlay = lv_label_create(lv_layer_top());
+    lv_obj_add_style(lbl_overlay, &style_overlay, LV_PART_MAIN);
+    lv_obj_align(lbl_overlay, LV_ALIGN_BOTTOM_LEFT, 2, -2);
+  }
+  if (!overlayEnabled) {
+    lv_obj_add_flag(lbl_overlay, LV_OBJ_FLAG_HIDDEN);
+    return;
+  }
+  lv_obj_clear_flag(lbl_overlay, LV_OBJ_FLAG_HIDDEN);
+  lv_label_set_text_fmt(lbl_overlay, "%lu.%lu fps  cpu %u/%u%%  heap %luk", (unsigned long)(fps10 / 10),
+                        (unsigned long)(fps10 % 10), task_stats(TASK_BMS).cpuPercent, task_stats(TASK_UI).cpuPercent,
+                        (unsigned long)(ESP.getFreeHeap() / 1024));
+}
+
+void diagnostics_update() {
+  bool visible = diag_table && lv_screen_active() == scr_diagnostics;
+  if (!visible && !overlayEnabled && !lbl_overlay) return;
+
+  unsigned long elapsed = millis() - lastUpdate;
+  if (elapsed < DIAG_UPDATE_INTERVAL && !updateNow) return;
+  if (elapsed == 0) return;
+  lastUpdate = millis();
+  updateNow = false;
+
+  const DisplayFlushStats &flush = display_flush_stats();
+  uint32_t refreshes = flush.refreshes - lastRefreshes;
+  uint32_t refreshUs = flush.refreshUs - lastRefreshUs;
+  uint32_t flushUs = flush.flushUs - lastFlushUs;
+  lastRefreshes = flush.refreshes;
+  lastRefreshUs = flush.refreshUs;
+  lastFlushUs = flush.flushUs;
+  uint32_t fps10 = elapsed ? refreshes * 10000 / elapsed : 0;
+
+  // Frames per second x10 per pack. Counted on every pass, also while the
+  // screen is hidden, so a visit doesn't divide a backlog by one interval.
+  uint32_t packRate10[BMS_MAX_DEVICES];
+  for (int i = 0; i < BMS_MAX_DEVICES; i++) {
+    const UiPackInfo *pack = ui_pack(i);
+    uint32_t frames = pack ? pack->frames : 0;
+    packRate10[i] = frames >= lastFrames[i] ? (frames - lastFrames[i]) * 10000 / elapsed : 0;
+    lastFrames[i] = frames;
+  }
+
+  update_overlay(fps10);
+  if (!visible) return;
+
+  set_row(ROW_FPS, "FPS", "%lu.%lu", (unsigned long)(fps10 / 10), (unsigned long)(fps10 % 10));
+  set_row(ROW_REFRESH, "Refresh", "%lu us avg, %lu max", (unsigned long)(refreshes ? refreshUs / refreshes : 0),
+          (unsigned long)flush.maxRefreshUs);
+  set_row(ROW_FLUSH, "Flush", "%lu us/refresh", (unsigned long)(refreshes ? flushUs / refreshes : 0));
+
+  UiMemStats mem;
+  ui_mem_stats(mem);
+  set_row(ROW_LVGL_MEM, "LVGL mem", "%u%% used, frag %u%%", mem.usedPercent, mem.fragPercent);
+
+  monitorFreeHeap();
+  set_row(ROW_HEAP, "Heap free", "%lu B", (unsigned long)ESP.getFreeHeap());
+  set_row(ROW_HEAP_MIN, "Heap min", "%lu B", (unsigned long)minFreeHeap);
+
+  const TaskStats &bmsTask = task_stats(TASK_BMS);
+  const TaskStats &uiTask = task_stats(TASK_UI);
+  set_row(ROW_STACK, "Stack free", "bms %lu, ui %lu", (unsigned long)bmsTask.stackHighWater,
+          (unsigned long)uiTask.stackHighWater);
+  set_row(ROW_CPU, "CPU", "bms %u%%, ui %u%%", bmsTask.cpuPercent, uiTask.cpuPercent);
+
+  const TouchStats &touch = display_touch_stats();
+  set_row(ROW_TOUCH, "Touch", "%lu us avg", (unsigned long)touch.avgLatencyUs);
+
+  int row = ROW_PACKS;
+  for (int i = 0; i < BMS_MAX_DEVICES; i++) {
+    const UiPackInfo *pack = ui_pack(i);
+    if (!pack) continue;
+    uint32_t rate10 = packRate10[i];
+    char name[12];
+    snprintf(name, sizeof(name), "Pack %d", i + 1);
+    set_row(row++, name, "%lu.%lu fr/s, %lu/%lu us", (unsigned long)(rate10 / 10), (unsigned long)(rate10 % 10),
+            (unsigned long)pack->lastParseUs, (unsigned long)pack->maxParseUs);
+  }
+  lv_table_set_row_count(diag_table, row);
+}
+
+void go_diagnostics() {
+  if (!scr_diagnostics) {
+    screen_cache_building(SCREEN_DIAGNOSTICS);
+    scr_diagnostics = new_screen(NULL);
+    lv_obj_set_size(scr_diagnostics, lv_disp_get_hor_res(NULL), lv_disp_get_ver_res(NULL));
+
+    lv_obj_t *chb_overlay = lv_checkbox_create(scr_diagnostics);
+    lv_checkbox_set_text(chb_overlay, "Overlay on all screens");
+    if (overlayEnabled) lv_obj_add_state(chb_overlay, LV_STATE_CHECKED);
+    lv_obj_add_event_cb(chb_overlay, [](lv_event_t *e) -> void {
+      overlayEnabled = lv_obj_has_state(lv_event_get_target_obj(e), LV_STATE_CHECKED);
+      updateNow = true;  // Apply right away
+    }, LV_EVENT_VALUE_CHANGED, NULL);
+
+    diag_table = lv_table_create(scr_diagnostics);
+    lv_table_set_column_count(diag_table, 2);
+    lv_table_set_column_width(diag_table, 0, 90);
+    lv_table_set_column_width(diag_table, 1, 190);
+    lv_obj_add_style(diag_table, &style_table_compact, LV_PART_ITEMS);
+    updateNow = true;  // Fill on the next pass
+  }
+
+  lv_label_set_text(lbl_header, "Diagnostics");
+  lv_obj_clear_flag(btn_back, LV_OBJ_FLAG_HIDDEN);
+  lv_obj_clear_flag(btn_exit, LV_OBJ_FLAG_HIDDEN);
+  screen_cache_show(SCREEN_DIAGNOSTICS);
+}
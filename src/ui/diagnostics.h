@@ -0,0 +1,20 @@
+#pragma once
+
+#include <lvgl.h>
+
+// Diagnostics screen and overlay
+// Shows refresh rate, render and flush time, LVGL and system heap, task
+// stacks and CPU, touch response and per-pack BLE frame rate and decode
+// time. The counters behind it are updated anyway; the screen only reads
+// them once every DIAG_UPDATE_INTERVAL, and only while it or the overlay
+// is visible.
+
+void go_diagnostics();
+
+// UI task, every pass. Cheap when nothing is shown.
+void diagnostics_update();
+
+// Clears widget pointers when the screen cache deletes the screen
+void diagnostics_on_evict();
+
+extern lv_obj_t *scr_diagnostics;
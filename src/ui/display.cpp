@@ -0,0 +1,253 @@
+#include <TFT_eSPI.h>
+#include <SPI.h>
+#include <XPT2046_Touchscreen.h>
+#include <esp_heap_caps.h>
+#include "display.h"
+#include "../config/config.h"
+#include "../utils/utils.h"
+#include "../tasks/tasks.h"
+
+// Panel on the TFT_eSPI bus (HSPI), touch controller on its own bus (VSPI)
+static TFT_eSPI tft;
+static SPIClass touchSpi(VSPI);
+// No IRQ pin for the library, it would otherwise own the interrupt; see touch_isr()
+static XPT2046_Touchscreen touch(TOUCH_CS);
+static lv_indev_t *touchIndev = nullptr;
+
+static DisplayFlushStats flushStats = {};
+static bool writing = false;    // CS held low across the areas of one refresh
+static uint32_t refreshStartUs = 0;
+
+static TouchStats touchStats = {};
+static volatile bool touchIrq = false;
+static volatile uint32_t touchIrqUs = 0;
+static bool touchPressed = false;
+static uint32_t lastContactMs = 0;
+static uint32_t lastTouchReadMs = 0;
+static lv_point_t touchPoint = { 0, 0 };
+static uint32_t pressPendingUs = 0;   // IRQ time of a press not yet on screen
+
+static void flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
+  uint32_t start = micros();
+  uint32_t w = lv_area_get_width(area);
+  uint32_t h = lv_area_get_height(area);
+
+  // LVGL renders little-endian RGB565, the panel expects big-endian
+  lv_draw_sw_rgb565_swap(px_map, w * h);
+
+#if DISPLAY_DMA
+  // Only wait when the previous area is still in flight. LVGL has already
+  // finished rendering this buffer and will render the next area into the other one.
+  uint32_t waitStart = micros();
+  tft.dmaWait();
+  flushStats.dmaWaitUs += micros() - waitStart;
+
+  if (!writing) {
+    tft.startWrite();
+    writing = true;
+  }
+  tft.pushImageDMA(area->x1, area->y1, w, h, (uint16_t *)px_map);
+#else
+  // Blocking single-buffer flush, the same as the LVGL TFT_eSPI driver
+  tft.startWrite();
+  tft.setAddrWindow(area->x1, area->y1, w, h);
+  tft.pushPixels((uint16_t *)px_map, w * h);
+  tft.endWrite();
+#endif
+
+  flushStats.flushes++;
+  flushStats.bytes += w * h * sizeof(uint16_t);
+  flushStats.flushUs += micros() - start;
+  lv_display_flush_ready(disp);
+}
+
+static void refresh_start_cb(lv_event_t *e) {
+  refreshStartUs = micros();
+}
+
+// Release the bus once the last area of a refresh has been sent
+static void refresh_done_cb(lv_event_t *e) {
+#if DISPLAY_DMA
+  if (writing) {
+    tft.dmaWait();
+    tft.endWrite();
+    writing = false;
+  }
+#endif
+  uint32_t us = micros() - refreshStartUs;
+  flushStats.refreshes++;
+  flushStats.refreshUs += us;
+  if (us > flushStats.maxRefreshUs) flushStats.maxRefreshUs = us;
+
+  // First refresh after a press was read, i.e. the earliest the UI could respond to it
+  if (pressPendingUs) {
+    uint32_t us = micros() - pressPendingUs;
+    pressPendingUs = 0;
+    touchStats.lastLatencyUs = us;
+    touchStats.avgLatencyUs = touchStats.presses > 1 ? touchStats.avgLatencyUs - touchStats.avgLatencyUs / 8 + us / 8 : us;
+    if (us > touchStats.maxLatencyUs) touchStats.maxLatencyUs = us;
+  }
+}
+
+// Rotation is done by the panel, LVGL only swaps its resolution
+static void rotation_changed_cb(lv_event_t *e) {
+  lv_display_t *disp = (lv_display_t *)lv_event_get_target(e);
+#if DISPLAY_DMA
+  tft.dmaWait();
+#endif
+  tft.setRotation((uint8_t)lv_display_get_rotation(disp));
+}
+
+// PENIRQ goes low when the panel is pressed
+static void IRAM_ATTR touch_isr() {
+  if (!touchIrq) touchIrqUs = micros();
+  touchIrq = true;
+  ui_wake_from_isr();
+}
+
+// Reports points in panel (rotation 0) coordinates, LVGL applies the display rotation.
+// The library already averages the closest two of three ADC samples per read;
+// on top of that small moves are held still and short contact gaps are bridged.
+static void touch_read_cb(lv_indev_t *indev, lv_indev_data_t *data) {
+  uint32_t now = millis();
+  touchStats.reads++;
+  if (touch.touched()) {
+    TS_Point p = touch.getPoint();
+    int32_t x = constrain(map(p.x, TOUCH_X_MIN, TOUCH_X_MAX, 0, TFT_WIDTH - 1), 0, TFT_WIDTH - 1);
+    int32_t y = constrain(map(p.y, TOUCH_Y_MIN, TOUCH_Y_MAX, 0, TFT_HEIGHT - 1), 0, TFT_HEIGHT - 1);
+    if (!touchPressed || abs(x - touchPoint.x) > TOUCH_JITTER_PX || abs(y - touchPoint.y) > TOUCH_JITTER_PX) {
+      touchPoint.x = x;
+      touchPoint.y = y;
+    }
+    if (!touchPressed) {
+      touchPressed = true;
+      touchStats.presses++;
+      pressPendingUs = touchIrqUs ? touchIrqUs : micros();
+    }
+    lastContactMs = now;
+  } else if (touchPressed && now - lastContactMs >= TOUCH_RELEASE_MS) {
+    touchPressed = false;
+  }
+  touchIrqUs = 0;
+  data->point = touchPoint;
+  data->state = touchPressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+}
+
+uint32_t display_touch_service() {
+  if (!touchIndev || (!touchIrq && !touchPressed)) return UINT32_MAX;
+
+  uint32_t now = millis();
+  if (touchIrq || now - lastTouchReadMs >= TOUCH_POLL_MS) {
+    if (touchIrq) touchStats.irqs++;
+    touchIrq = false;
+    lastTouchReadMs = now;
+    lv_indev_read(touchIndev);
+  }
+  if (!touchPressed) return UINT32_MAX;
+  uint32_t elapsed = now - lastTouchReadMs;
+  return elapsed < TOUCH_POLL_MS ? TOUCH_POLL_MS - elapsed : 0;
+}
+
+bool display_touch_pending() {
+  return touchIrq;
+}
+
+void display_touch_swallow() {
+  if (touchIndev) lv_indev_wait_release(touchIndev);
+}
+
+const TouchStats &display_touch_stats() {
+  return touchStats;
+}
+
+void display_backlight(uint8_t level) {
+  ledcWrite(DISPLAY_BL_CHANNEL, level);
+}
+
+int display_light_level() {
+#if IDLE_LDR_PIN >= 0
+  return constrain(map(analogRead(IDLE_LDR_PIN), IDLE_LDR_DARK, IDLE_LDR_BRIGHT, 0, 255), 0, 255);
+#else
+  return -1;
+#endif
+}
+
+lv_display_t *display_init(lv_display_rotation_t rotation) {
+  lv_init();
+  lv_tick_set_cb([]() -> uint32_t { return millis(); });
+
+  tft.begin();
+  tft.setSwapBytes(false);  // Swapped in flush_cb
+#if DISPLAY_DMA
+  tft.initDMA();
+#endif
+
+  ledcSetup(DISPLAY_BL_CHANNEL, DISPLAY_BL_FREQ, 8);
+  ledcAttachPin(TFT_BL, DISPLAY_BL_CHANNEL);
+  display_backlight(255);
+
+  lv_display_t *disp = lv_display_create(TFT_WIDTH, TFT_HEIGHT);
+  lv_display_set_flush_cb(disp, flush_cb);
+  lv_display_add_event_cb(disp, refresh_start_cb, LV_EVENT_REFR_START, NULL);
+  lv_display_add_event_cb(disp, refresh_done_cb, LV_EVENT_REFR_READY, NULL);
+  lv_display_add_event_cb(disp, rotation_changed_cb, LV_EVENT_RESOLUTION_CHANGED, NULL);
+
+  // Sized for the longer side so every rotation fits
+  uint32_t bufSize = max(TFT_WIDTH, TFT_HEIGHT) * DISPLAY_BUF_LINES * sizeof(uint16_t);
+  void *buf1 = heap_caps_malloc(bufSize, MALLOC_CAP_DMA);
+  void *buf2 = DISPLAY_DMA ? heap_caps_malloc(bufSize, MALLOC_CAP_DMA) : NULL;
+  if (!buf1 || (DISPLAY_DMA && !buf2)) {
+    DEBUG_PRINTLN("Display buffer allocation failed");
+  }
+  lv_display_set_buffers(disp, buf1, buf2, bufSize, LV_DISPLAY_RENDER_MODE_PARTIAL);
+  lv_display_set_rotation(disp, rotation);
+  DEBUG_PRINTF("Display: %s, %d x %lu byte buffers\n", DISPLAY_DMA ? "DMA" : "blocking",
+               buf2 ? 2 : 1, (unsigned long)bufSize);
+
+  touchSpi.begin(TOUCH_SPI_CLK, TOUCH_SPI_MISO, TOUCH_SPI_MOSI, TOUCH_CS);
+  touch.begin(touchSpi);
+  touch.setRotation(0);
+
+  // Event mode: LVGL no longer polls the panel on a timer, display_touch_service() reads it
+  touchIndev = lv_indev_create();
+  lv_indev_set_type(touchIndev, LV_INDEV_TYPE_POINTER);
+  lv_indev_set_read_cb(touchIndev, touch_read_cb);
+  lv_indev_set_mode(touchIndev, LV_INDEV_MODE_EVENT);
+  pinMode(TOUCH_IRQ, INPUT);
+  attachInterrupt(digitalPinToInterrupt(TOUCH_IRQ), touch_isr, FALLING);
+
+  return disp;
+}
+
+const DisplayFlushStats &display_flush_stats() {
+  return flushStats;
+}
+
+void display_reset_flush_stats() {
+  flushStats = {};
+}
+
+void display_benchmark(int frames) {
+  lv_display_t *disp = lv_display_get_default();
+  lv_obj_t *scr = lv_screen_active();
+  if (!disp || !scr || frames <= 0) return;
+
+  display_reset_flush_stats();
+  uint32_t start = micros();
+  for (int i = 0; i < frames; i++) {
+    lv_obj_invalidate(scr);
+    lv_refr_now(disp);
+  }
+  uint32_t elapsed = micros() - start;
+  if (elapsed == 0) elapsed = 1;
+
+  const DisplayFlushStats &s = flushStats;
+  DEBUG_PRINTF("Display benchmark (%s, %d lines): %d frames in %lu ms, %.1f fps\n",
+               DISPLAY_DMA ? "DMA, 2 buffers" : "blocking, 1 buffer", DISPLAY_BUF_LINES, frames,
+               (unsigned long)(elapsed / 1000), frames * 1000000.0f / elapsed);
+  DEBUG_PRINTF("  %lu flushes, %lu kB at %lu kB/s, %lu%% of the time in flush (%lu%% waiting for DMA)\n",
+               (unsigned long)s.flushes, (unsigned long)(s.bytes / 1024),
+               (unsigned long)(s.bytes * 1000000 / elapsed / 1024),
+               (unsigned long)(s.flushUs * 100 / elapsed), (unsigned long)(s.dmaWaitUs * 100 / elapsed));
+  display_reset_flush_stats();
+}
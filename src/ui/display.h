@@ -0,0 +1,64 @@
+#pragma once
+
+#include <lvgl.h>
+
+// Display and touch driver for the CYD
+// Panel, SPI pins and clock come from configs/cyd/User_Setup.h (TFT_eSPI),
+// color depth and refresh period from configs/cyd/lv_conf.h.
+//
+// LVGL renders into two partial buffers of DISPLAY_BUF_LINES lines. With
+// DISPLAY_DMA enabled a flush only starts the SPI DMA transfer and returns,
+// so LVGL renders the next area into the other buffer while the previous
+// one is still being sent. The transfer is waited for only when that buffer
+// is needed again.
+
+// Touch is interrupt driven: the XPT2046 pen IRQ wakes the UI task, which
+// then reads the panel every TOUCH_POLL_MS until the press is released. An
+// idle panel costs no reads and no wakeups.
+
+// Initializes LVGL, the panel, touch and backlight. Call once from the UI task.
+lv_display_t *display_init(lv_display_rotation_t rotation);
+
+// 0 (off) - 255 (full)
+void display_backlight(uint8_t level);
+
+// Ambient light from the LDR, 0 (dark) - 255 (bright), -1 without a sensor
+int display_light_level();
+
+struct DisplayFlushStats {
+  uint32_t flushes;           // Areas sent to the panel
+  uint64_t bytes;             // Pixel data sent
+  uint64_t flushUs;           // Time spent inside the flush callback
+  uint64_t dmaWaitUs;         // Part of flushUs spent waiting for the previous transfer
+  uint32_t refreshes;         // Completed LVGL refresh cycles
+  uint64_t refreshUs;         // Render plus flush, from refresh start to the last area sent
+  uint32_t maxRefreshUs;
+};
+
+const DisplayFlushStats &display_flush_stats();
+void display_reset_flush_stats();
+
+// Reads touch after an IRQ and while pressed. Call from the UI task before
+// lv_timer_handler(); returns ms until the next read is due, UINT32_MAX when idle.
+uint32_t display_touch_service();
+
+// The panel has been pressed and display_touch_service() has not read it yet
+bool display_touch_pending();
+
+// Ignores the current press until it is released, e.g. a tap that only wakes the screen
+void display_touch_swallow();
+
+struct TouchStats {
+  uint32_t irqs;              // Pen interrupts that led to a read
+  uint32_t presses;
+  uint32_t reads;             // Panel reads, only while pressed or right after an IRQ
+  uint32_t lastLatencyUs;     // Pen IRQ to the end of the first refresh after the press
+  uint32_t avgLatencyUs;
+  uint32_t maxLatencyUs;
+};
+
+const TouchStats &display_touch_stats();
+
+// Measurement mode: redraws the whole active screen `frames` times and
+// prints FPS and SPI throughput for the configured buffer and DMA setup
+void display_benchmark(int frames);
@@ -0,0 +1,49 @@
+#include "fonts.h"
+#include "display.h"
+#include "../utils/utils.h"
+
+// Render time per frame of one label in `font`, changing text every frame
+// the way the dashboard does. Flush time is left out, so this is the glyph
+// lookup and blending cost alone.
+static uint32_t time_label(lv_obj_t *parent, const lv_font_t *font, const char *fmt, int iterations) {
+  lv_obj_t *label = lv_label_create(parent);
+  lv_obj_set_style_text_font(label, font, LV_PART_MAIN);
+  lv_obj_center(label);
+  lv_label_set_text_fmt(label, fmt, 0, 0);
+  lv_refr_now(NULL);
+
+  display_reset_flush_stats();
+  for (int n = 0; n < iterations; n++) {
+    lv_label_set_text_fmt(label, fmt, n % 100, 3000 + n % 700);
+    lv_refr_now(NULL);
+  }
+  const DisplayFlushStats &stats = display_flush_stats();
+  uint64_t renderUs = stats.refreshUs > stats.flushUs ? stats.refreshUs - stats.flushUs : 0;
+  lv_obj_delete(label);
+  return renderUs / iterations;
+}
+
+void fonts_benchmark(int iterations) {
+  if (iterations <= 0) return;
+  lv_obj_t *previous = lv_screen_active();
+  lv_obj_t *scratch = lv_obj_create(NULL);
+  lv_screen_load(scratch);
+
+  uint32_t overlayUs = time_label(scratch, FONT_OVERLAY, "%d fps  heap %dk", iterations);
+  uint32_t smallUs = time_label(scratch, FONT_SMALL, "%d us avg, %d max", iterations);
+  uint32_t bodyUs = time_label(scratch, FONT_BODY, "%d mV, %d mV", iterations);
+  uint32_t titleUs = time_label(scratch, FONT_TITLE, "V: 53.%02d   A: %d", iterations);
+  uint32_t socUs = time_label(scratch, FONT_SOC, "%d%%", iterations);
+
+  lv_screen_load(previous);
+  lv_obj_delete(scratch);
+
+#ifdef UI_SUBSET_FONTS
+  const char *fontSet = "subset";
+#else
+  const char *fontSet = "built-in";
+#endif
+  DEBUG_PRINTF("Font benchmark (%s fonts, %d frames), render us/frame: overlay %lu, small %lu, body %lu, title %lu, soc %lu\n",
+               fontSet, iterations, (unsigned long)overlayUs, (unsigned long)smallUs, (unsigned long)bodyUs,
+               (unsigned long)titleUs, (unsigned long)socUs);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <lvgl.h>
+
+// UI fonts by role
+// With UI_SUBSET_FONTS (defined by gen_fonts.py when it could generate
+// src/ui/fonts/) the fixed-text roles use subsets holding only the
+// characters found in src/ui string literals, and the SOC label uses a
+// digit strip. Otherwise they fall back to the built-in Montserrat sizes.
+// FONT_BODY is always the built-in default font: it shows BLE device names
+// and other text only known at runtime.
+
+#ifdef UI_SUBSET_FONTS
+LV_FONT_DECLARE(font_ui_10)
+LV_FONT_DECLARE(font_ui_12)
+LV_FONT_DECLARE(font_ui_18)
+LV_FONT_DECLARE(font_soc_28)
+
+#define FONT_OVERLAY  (&font_ui_10)   // Diagnostics overlay
+#define FONT_SMALL    (&font_ui_12)   // Compact tables
+#define FONT_TITLE    (&font_ui_18)   // Header, navigation symbols, dashboard values
+#define FONT_SOC      (&font_soc_28)  // Digits and '%' only
+#else
+#define FONT_OVERLAY  (&lv_font_montserrat_10)
+#define FONT_SMALL    (&lv_font_montserrat_12)
+#define FONT_TITLE    (&lv_font_montserrat_18)
+#define FONT_SOC      (&lv_font_montserrat_28)
+#endif
+
+#define FONT_BODY     (&lv_font_montserrat_14)
+
+// Measurement mode: redraws dashboard-style labels in every font role
+// `iterations` times and prints render time per frame, without the flush
+void fonts_benchmark(int iterations);
@@ -0,0 +1,129 @@
+#include "idle.h"
+#include "display.h"
+#include "screens.h"
+#include "../config/config.h"
+#include "../utils/utils.h"
+#include "../bms/telemetry.h"
+
+static IdleState state = IDLE_ACTIVE;
+static uint8_t brightness = 255;
+static uint32_t blankTimeout = IDLE_BLANK_TIMEOUT;
+static bool autoBrightness = IDLE_LDR_AUTO;
+static int32_t ambient = -1;          // Smoothed light level 0 - 255, -1 before the first sample
+static unsigned long lastLdrSample = 0;
+static uint8_t shownLevel = 255;       // display_init() starts at full brightness
+
+// Active level after auto brightness, never below IDLE_LDR_MIN_LEVEL unless the user set it lower
+static uint8_t active_level() {
+  if (!autoBrightness || ambient < 0 || brightness <= IDLE_LDR_MIN_LEVEL) return brightness;
+  return IDLE_LDR_MIN_LEVEL + (brightness - IDLE_LDR_MIN_LEVEL) * ambient / 255;
+}
+
+static void apply_backlight() {
+  uint8_t level = state == IDLE_BLANKED ? 0 : active_level();
+  if (state == IDLE_DIMMED && level > IDLE_DIM_LEVEL) level = IDLE_DIM_LEVEL;
+  if (level == shownLevel) return;
+  shownLevel = level;
+  display_backlight(level);
+}
+
+// Stop or restart everything the UI task would draw with
+static void set_rendering(bool enable) {
+  lv_display_t *disp = lv_display_get_default();
+  lv_timer_t *refr = lv_display_get_refr_timer(disp);
+  telemetry_enable(TELEMETRY_UI, enable);
+  lv_display_enable_invalidation(disp, enable);
+  if (enable) {
+    update_bms_display_resumed();
+    lv_timer_resume(refr);
+    lv_obj_invalidate(lv_screen_active());
+    lv_obj_invalidate(lv_layer_top());
+  } else {
+    lv_timer_pause(refr);
+  }
+}
+
+static void set_state(IdleState next) {
+  if (next == state) return;
+  DEBUG_PRINTF("Idle: %s\n", next == IDLE_ACTIVE ? "active" : next == IDLE_DIMMED ? "dimmed" : "blanked");
+  if (state == IDLE_BLANKED) set_rendering(true);
+  state = next;
+  if (state == IDLE_BLANKED) set_rendering(false);
+  apply_backlight();
+}
+
+static void sample_ldr() {
+  int light = display_light_level();
+  if (light < 0) return;
+  // Smooth over a few samples so passing shadows don't pump the backlight
+  ambient = ambient < 0 ? light : ambient + (light - ambient) / 4;
+}
+
+uint32_t idle_service() {
+  uint32_t inactive = lv_display_get_inactive_time(NULL);
+  IdleState next = IDLE_ACTIVE;
+  uint32_t wait = UINT32_MAX;
+  if (blankTimeout && inactive >= blankTimeout) {
+    next = IDLE_BLANKED;
+  } else if (IDLE_DIM_TIMEOUT && inactive >= IDLE_DIM_TIMEOUT) {
+    next = IDLE_DIMMED;
+    if (blankTimeout) wait = blankTimeout - inactive;
+  } else {
+    if (IDLE_DIM_TIMEOUT) wait = IDLE_DIM_TIMEOUT - inactive;
+    else if (blankTimeout) wait = blankTimeout - inactive;
+  }
+  set_state(next);
+
+  // The sensor is only worth reading while the backlight is on
+  if (autoBrightness && state != IDLE_BLANKED) {
+    unsigned long elapsed = millis() - lastLdrSample;
+    if (elapsed >= IDLE_LDR_INTERVAL) {
+      lastLdrSample = millis();
+      sample_ldr();
+      apply_backlight();
+      elapsed = 0;
+    }
+    if (IDLE_LDR_INTERVAL - elapsed < wait) wait = IDLE_LDR_INTERVAL - elapsed;
+  }
+  return wait;
+}
+
+void idle_wake() {
+  lv_display_trigger_activity(NULL);
+  set_state(IDLE_ACTIVE);
+}
+
+IdleState idle_state() {
+  return state;
+}
+
+void idle_set_brightness(uint8_t level) {
+  brightness = level;
+  apply_backlight();
+}
+
+uint8_t idle_brightness() {
+  return brightness;
+}
+
+void idle_set_blank_timeout(uint32_t ms) {
+  blankTimeout = ms;
+}
+
+uint32_t idle_blank_timeout() {
+  return blankTimeout;
+}
+
+void idle_set_auto_brightness(bool enable) {
+  autoBrightness = enable;
+  if (enable) {
+    ambient = -1;
+    lastLdrSample = millis();
+    sample_ldr();
+  }
+  apply_backlight();
+}
+
+bool idle_auto_brightness() {
+  return autoBrightness;
+}
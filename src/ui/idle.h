@@ -0,0 +1,41 @@
+#pragma once
+
+#include <lvgl.h>
+
+// Backlight idle manager
+// Dims the backlight after IDLE_DIM_TIMEOUT without touch and blanks it
+// after the screen-off timeout chosen on the backlight screen. While blanked
+// the display refresh timer is paused, nothing can invalidate, and the UI
+// telemetry consumer is switched off, so the UI task neither formats nor
+// renders anything. The first touch only wakes the screen; it is not passed
+// on to the widget under the finger.
+//
+// With auto brightness on, the level set by the user is scaled by the CYD
+// light sensor (LDR), sampled every IDLE_LDR_INTERVAL.
+
+enum IdleState {
+  IDLE_ACTIVE,
+  IDLE_DIMMED,
+  IDLE_BLANKED
+};
+
+// UI task, every pass. Returns ms until the next state change or LDR sample is due.
+uint32_t idle_service();
+
+// Back to IDLE_ACTIVE now, e.g. for an alert
+void idle_wake();
+
+IdleState idle_state();
+inline bool idle_blanked() { return idle_state() == IDLE_BLANKED; }
+
+// Brightness while active, 0 - 255
+void idle_set_brightness(uint8_t level);
+uint8_t idle_brightness();
+
+// 0 never blanks
+void idle_set_blank_timeout(uint32_t ms);
+uint32_t idle_blank_timeout();
+
+// Has no effect when the display has no light sensor
+void idle_set_auto_brightness(bool enable);
+bool idle_auto_brightness();
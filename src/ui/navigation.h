@@ -8,7 +8,9 @@ enum ScreenID {
   SCREEN_DISPLAY_SETTINGS,
   SCREEN_BL,
   SCREEN_CELL_VOLTAGES,
-  SCREEN_CELL_RESISTANCES
+  SCREEN_CELL_RESISTANCES,
+  SCREEN_TRENDS,
+  SCREEN_DIAGNOSTICS
 };
 
 // Navigation stack size
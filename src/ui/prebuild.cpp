@@ -0,0 +1,54 @@
+#include "prebuild.h"
+#include "screen_cache.h"
+#include "../config/config.h"
+#include "../utils/utils.h"
+
+#define PREBUILD_SLOTS 8
+
+struct PrebuildEntry {
+  ScreenID id;
+  lv_obj_t **screen;
+  void (*build)();
+};
+
+static PrebuildEntry entries[PREBUILD_SLOTS];
+static int entryCount = 0;
+static int next = 0;
+static unsigned long lastSlice = 0;
+static bool waitingForRoom = false;  // Logged once per wait
+
+void prebuild_add(ScreenID id, lv_obj_t **screen, void (*build)()) {
+  if (entryCount >= PREBUILD_SLOTS) return;
+  entries[entryCount++] = { id, screen, build };
+}
+
+uint32_t prebuild_service(bool busy) {
+  // Screens built before, on a visit, don't need it
+  while (next < entryCount && (*entries[next].screen || screen_cache_cost(entries[next].id))) next++;
+  if (next >= entryCount) return UINT32_MAX;
+
+  unsigned long now = millis();
+  if (now < PREBUILD_START_DELAY) return PREBUILD_START_DELAY - now;
+  if (now - lastSlice < PREBUILD_INTERVAL) return PREBUILD_INTERVAL - (now - lastSlice);
+  if (busy) return PREBUILD_INTERVAL;
+
+  // Without room the same screen is tried again next interval, memory may have been freed by then
+  PrebuildEntry &e = entries[next];
+  if (!screen_cache_has_room(PREBUILD_COST_GUESS)) {
+    if (!waitingForRoom) DEBUG_PRINTF("Prebuild: no room for screen %d\n", e.id);
+    waitingForRoom = true;
+    lastSlice = millis();
+    return PREBUILD_INTERVAL;
+  }
+  waitingForRoom = false;
+  next++;
+
+  uint32_t start = micros();
+  e.build();
+  screen_cache_built(e.id);
+  uint32_t us = micros() - start;
+  if (us > PREBUILD_SLICE_WARN_US) DEBUG_PRINTF("Prebuild: screen %d took %lu us\n", e.id, (unsigned long)us);
+
+  lastSlice = millis();
+  return next < entryCount ? PREBUILD_INTERVAL : UINT32_MAX;
+}
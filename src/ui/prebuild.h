@@ -0,0 +1,22 @@
+#pragma once
+
+#include <lvgl.h>
+#include "navigation.h"
+
+// Idle-time screen prebuilder
+// Builds the screens a user is likely to open next before they are first
+// tapped, so the first visit only has to load them. One screen is built
+// per slice, at most every PREBUILD_INTERVAL, starting PREBUILD_START_DELAY
+// after boot, and only while nothing else is going on: no touch in
+// progress and no data waiting to be drawn. A screen is only built when
+// the screen cache has room for it, otherwise it is tried again every
+// PREBUILD_INTERVAL. Once built it sits at the back of the LRU
+// order, so it is the first to go under memory pressure. Screens that
+// have been built once, by a tap or here, are not prebuilt again.
+
+// Registration order is build order. `build` must create the screen without showing it.
+void prebuild_add(ScreenID id, lv_obj_t **screen, void (*build)());
+
+// UI task, every pass. Returns ms until the next slice could run, UINT32_MAX
+// when done. Never done while the cache has no room for the next screen.
+uint32_t prebuild_service(bool busy);
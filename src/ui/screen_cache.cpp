@@ -0,0 +1,205 @@
+#include "screen_cache.h"
+#include "../config/config.h"
+#include "../utils/utils.h"
+
+#define SCREEN_CACHE_SLOTS 16
+
+struct CachedScreen {
+  ScreenID id;
+  lv_obj_t **screen;
+  void (*on_evict)();
+  bool pinned;
+  uint32_t costBytes;         // Heap used by the last build, 0 until measured
+  uint32_t lastShown;         // Use counter for LRU ordering
+  uint16_t builds;
+  ScreenTiming timing;
+};
+
+static CachedScreen entries[SCREEN_CACHE_SLOTS];
+static int entryCount = 0;
+static uint32_t useCounter = 0;
+
+// Build in progress
+static int buildingIdx = -1;
+static uint32_t freeBeforeBuild = 0;
+static uint32_t buildStartUs = 0;
+
+// A show may have pushed the cache over its limits, see screen_cache_service()
+static bool budgetPending = false;
+
+// Navigation waiting for its first refresh
+static int navIdx = -1;
+static uint32_t navStartUs = 0;
+static bool navBuilt = false;
+
+static CachedScreen *find(ScreenID id) {
+  for (int i = 0; i < entryCount; i++) {
+    if (entries[i].id == id) return &entries[i];
+  }
+  return nullptr;
+}
+
+void ui_mem_stats(UiMemStats &stats) {
+#if LV_USE_STDLIB_MALLOC == LV_STDLIB_BUILTIN
+  lv_mem_monitor_t mon;
+  lv_mem_monitor(&mon);
+  stats.totalBytes = mon.total_size;
+  stats.freeBytes = mon.free_size;
+  stats.largestFreeBytes = mon.free_biggest_size;
+  stats.usedPercent = mon.used_pct;
+  stats.fragPercent = mon.frag_pct;
+#else
+  // LVGL allocates from the system heap, which it shares with NimBLE and the tasks
+  stats.totalBytes = ESP.getHeapSize();
+  stats.freeBytes = ESP.getFreeHeap();
+  stats.largestFreeBytes = ESP.getMaxAllocHeap();
+  stats.usedPercent = stats.totalBytes ? 100 - (uint64_t)stats.freeBytes * 100 / stats.totalBytes : 0;
+  stats.fragPercent = stats.freeBytes ? 100 - (uint64_t)stats.largestFreeBytes * 100 / stats.freeBytes : 0;
+#endif
+}
+
+void screen_cache_register(ScreenID id, lv_obj_t **screen, void (*on_evict)(), bool pinned) {
+  if (find(id) || entryCount >= SCREEN_CACHE_SLOTS) return;
+  entries[entryCount++] = { id, screen, on_evict, pinned, 0, 0, 0, {} };
+}
+
+void screen_cache_building(ScreenID id) {
+  CachedScreen *e = find(id);
+  if (!e) return;
+  UiMemStats mem;
+  ui_mem_stats(mem);
+  buildingIdx = e - entries;
+  freeBeforeBuild = mem.freeBytes;
+  buildStartUs = micros();
+  e->builds++;
+}
+
+// Records what the build in progress cost, once it is complete
+static void finish_build(CachedScreen &e, const char *how) {
+  UiMemStats mem;
+  ui_mem_stats(mem);
+  e.costBytes = freeBeforeBuild > mem.freeBytes ? freeBeforeBuild - mem.freeBytes : 0;
+  buildingIdx = -1;
+  DEBUG_PRINTF("%s screen %d: %lu bytes, %lu us (build #%u)\n", how, e.id, (unsigned long)e.costBytes,
+               (unsigned long)(micros() - buildStartUs), e.builds);
+}
+
+static uint32_t cached_bytes() {
+  uint32_t total = 0;
+  for (int i = 0; i < entryCount; i++) {
+    if (*entries[i].screen) total += entries[i].costBytes;
+  }
+  return total;
+}
+
+static bool under_pressure() {
+  UiMemStats mem;
+  ui_mem_stats(mem);
+  return mem.freeBytes < SCREEN_CACHE_MIN_FREE || cached_bytes() > SCREEN_CACHE_BUDGET;
+}
+
+bool screen_cache_has_room(uint32_t bytes) {
+  UiMemStats mem;
+  ui_mem_stats(mem);
+  return mem.freeBytes >= SCREEN_CACHE_MIN_FREE + bytes && cached_bytes() + bytes <= SCREEN_CACHE_BUDGET;
+}
+
+uint32_t screen_cache_cost(ScreenID id) {
+  CachedScreen *e = find(id);
+  return e ? e->costBytes : 0;
+}
+
+const ScreenTiming *screen_cache_timing(ScreenID id) {
+  CachedScreen *e = find(id);
+  return e ? &e->timing : nullptr;
+}
+
+// First refresh after a screen was loaded, i.e. when the user sees it
+static void refresh_ready_cb(lv_event_t *event) {
+  if (navIdx < 0) return;
+  CachedScreen &e = entries[navIdx];
+  uint32_t us = micros() - navStartUs;
+  navIdx = -1;
+  e.timing.lastUs = us;
+  if (!e.timing.firstUs) {
+    e.timing.firstUs = us;
+    e.timing.firstBuilt = navBuilt;
+  }
+}
+
+static void evict(CachedScreen &e) {
+  DEBUG_PRINTF("Evicting screen %d (%lu bytes)\n", e.id, (unsigned long)e.costBytes);
+  lv_obj_delete(*e.screen);
+  *e.screen = nullptr;
+  if (e.on_evict) e.on_evict();
+}
+
+static void enforce_budget() {
+  lv_obj_t *active = lv_screen_active();
+  while (under_pressure()) {
+    CachedScreen *lru = nullptr;
+    for (int i = 0; i < entryCount; i++) {
+      CachedScreen &e = entries[i];
+      if (e.pinned || !*e.screen || *e.screen == active) continue;
+      if (!lru || e.lastShown < lru->lastShown) lru = &e;
+    }
+    if (!lru) break;  // Only the active and pinned screens are left
+    evict(*lru);
+  }
+}
+
+void screen_cache_show(ScreenID id) {
+  CachedScreen *e = find(id);
+  if (!e || !*e->screen) return;
+
+  static bool timing = false;
+  if (!timing) {
+    lv_display_add_event_cb(lv_display_get_default(), refresh_ready_cb, LV_EVENT_REFR_READY, NULL);
+    timing = true;
+  }
+  navBuilt = buildingIdx == e - entries;
+  navStartUs = navBuilt ? buildStartUs : micros();
+  navIdx = e - entries;
+
+  lv_screen_load(*e->screen);
+  e->lastShown = ++useCounter;
+  if (navBuilt) finish_build(*e, "Built");
+
+  // Not from here: go_*() runs in a click handler, possibly of a widget on
+  // the screen that would be evicted
+  budgetPending = true;
+}
+
+void screen_cache_service() {
+  if (!budgetPending) return;
+  budgetPending = false;
+  enforce_budget();
+}
+
+bool screen_cache_built(ScreenID id) {
+  CachedScreen *e = find(id);
+  if (!e || buildingIdx != e - entries) return false;
+  finish_build(*e, "Prebuilt");
+  e->lastShown = 0;  // First to go under pressure
+  if (!e->timing.firstUs) e->timing.prebuilt = true;
+  if (under_pressure()) {
+    evict(*e);
+    return false;
+  }
+  return true;
+}
+
+void screen_cache_report() {
+  UiMemStats mem;
+  ui_mem_stats(mem);
+  DEBUG_PRINTF("UI memory: %lu/%lu bytes free (%u%% used), largest block %lu, frag %u%%, screens %lu bytes\n",
+               (unsigned long)mem.freeBytes, (unsigned long)mem.totalBytes, mem.usedPercent,
+               (unsigned long)mem.largestFreeBytes, mem.fragPercent, (unsigned long)cached_bytes());
+  for (int i = 0; i < entryCount; i++) {
+    const CachedScreen &e = entries[i];
+    DEBUG_PRINTF("  screen %d: %s, %lu bytes, built %u times, first visit %lu us (%s), last %lu us\n", e.id,
+                 *e.screen ? "cached" : "evicted", (unsigned long)e.costBytes, e.builds,
+                 (unsigned long)e.timing.firstUs, e.timing.prebuilt ? "prebuilt" : e.timing.firstBuilt ? "built" : "cached",
+                 (unsigned long)e.timing.lastUs);
+  }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <lvgl.h>
+#include "navigation.h"
+
+// LRU screen cache
+// Screens are still built on first visit by their go_*() function, but are
+// no longer kept forever. The cache records what each screen cost to
+// build, and when the LVGL heap runs low or the cached screens exceed
+// SCREEN_CACHE_BUDGET, the least recently shown screens are deleted. The
+// next go_*() call simply builds them again.
+
+// on_evict clears widget pointers that live inside the screen
+void screen_cache_register(ScreenID id, lv_obj_t **screen, void (*on_evict)(), bool pinned = false);
+
+// Call at the start of a go_*() build block, so the build cost can be measured
+void screen_cache_building(ScreenID id);
+
+// Loads the screen and marks it most recently used. Eviction under
+// pressure waits for screen_cache_service(). Also starts timing the
+// navigation, see ScreenTiming.
+void screen_cache_show(ScreenID id);
+
+// UI task loop, outside any LVGL event handler. Evicts the least recently
+// shown screens if the last screen_cache_show() broke the cache limits.
+void screen_cache_service();
+
+// Ends a build that is not followed by screen_cache_show(), i.e. a
+// prebuild. The screen goes to the back of the LRU order, and is deleted
+// again right away if keeping it would break the cache limits.
+// Returns false in that case.
+bool screen_cache_built(ScreenID id);
+
+// Whether `bytes` more could be cached without evicting anything
+bool screen_cache_has_room(uint32_t bytes);
+
+// Heap used by the screen's last build, 0 if it was never built
+uint32_t screen_cache_cost(ScreenID id);
+
+// Navigation latency: from the start of the go_*() call that showed the
+// screen (its build, if it had to build) to the end of the first display
+// refresh after it was loaded
+struct ScreenTiming {
+  uint32_t firstUs;           // First visit since boot
+  uint32_t lastUs;
+  bool firstBuilt;            // First visit had to build the screen
+  bool prebuilt;              // Built by the prebuilder before its first visit
+};
+
+const ScreenTiming *screen_cache_timing(ScreenID id);
+
+struct UiMemStats {
+  uint32_t totalBytes;
+  uint32_t freeBytes;
+  uint32_t largestFreeBytes;
+  uint8_t usedPercent;
+  uint8_t fragPercent;        // 100 - largest free block as a share of free memory
+};
+
+// Reports the allocator LVGL actually uses, see LV_USE_STDLIB_MALLOC in lv_conf.h
+void ui_mem_stats(UiMemStats &stats);
+
+// Print heap usage, fragmentation and the cost of each cached screen
+void screen_cache_report();
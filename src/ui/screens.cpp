@@ -1,18 +1,26 @@
-#include <LVGL_CYD.h>
 #include "screens.h"
 #include "navigation.h"
 #include "../utils/utils.h"
+#include "../utils/fixed_fmt.h"
 #include "../config/config.h"
-#include "../bms/jkbms.h"
+#include "../tasks/tasks.h"
+#include "ui_queue.h"
+#include "dashboard.h"
+#include "cell_bars.h"
+#include "fonts.h"
+#include "trends.h"
+#include "screen_cache.h"
+#include "prebuild.h"
+#include "display.h"
+#include "idle.h"
+#include "diagnostics.h"
+#include "theme.h"
 
 // Global LVGL elements
-lv_obj_t *soc_gauge = nullptr;
-lv_obj_t *soc_gauge_label = nullptr;
 lv_obj_t *battery_current_label = nullptr;
-lv_obj_t *battery_voltage_and_current_label = nullptr;
-lv_obj_t *cell_voltage_table = nullptr;
+lv_obj_t *cell_voltage_bars = nullptr;
 lv_obj_t *delta_voltages_table = nullptr;
-lv_obj_t *wire_res_table = nullptr;
+lv_obj_t *wire_res_bars = nullptr;
 lv_obj_t *res_high_low_avg_table = nullptr;
 
 // Screen objects
@@ -29,171 +37,221 @@ lv_obj_t *jk_devices_scroll_container = nullptr;
 lv_obj_t *btn_back = nullptr;
 lv_obj_t *btn_exit = nullptr;
 lv_obj_t *lbl_header = nullptr;
+lv_obj_t *lbl_stale = nullptr;
 lv_obj_t *slider_bl = nullptr;
 lv_obj_t *horizontal = nullptr;
 lv_obj_t *vertical = nullptr;
 
-// Global variables for LVGL components
-float battery_voltage;
-float battery_current;
-
 // Creates a new obj to use as base screen
 lv_obj_t *new_screen(lv_obj_t *parent) {
   lv_obj_t *obj = lv_obj_create(parent);
-  lv_obj_set_style_bg_opa(obj, LV_OPA_TRANSP, LV_PART_MAIN);
+  lv_obj_add_style(obj, &style_transparent, LV_PART_MAIN);
+  lv_obj_add_style(obj, &style_screen, LV_PART_MAIN);
   lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
-  lv_obj_set_style_border_width(obj, 0, 0);
   lv_obj_set_layout(obj, LV_LAYOUT_FLEX);
   lv_obj_set_flex_flow(obj, LV_FLEX_FLOW_COLUMN);
   lv_obj_set_flex_align(obj, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-  lv_obj_set_style_pad_top(obj, 20, LV_PART_MAIN);
-  lv_obj_set_style_pad_row(obj, 10, LV_PART_MAIN);
   return obj;
 }
 
-// Update BMS display with latest data from notify callback
-void update_bms_display() {
-  // TODO: fix not both BMS data showing in UI
-  // If one BMS is connected it hogs the UI. Both BMS' 
-  // data shows up in the Serial monitor, so it's getting the data.
-  bool connected = false;
-  JKBMS *connectedBMS = nullptr;
-  
-  // Find first connected BMS
-  for (int i = 0; i < bmsDeviceCount; i++) {
-    if (jkBmsDevices[i].connected) {
-      connected = true;
-      connectedBMS = &jkBmsDevices[i];
-      break;
-    }
+// Widget binding for update_bms_display()
+// Each value written to a widget is remembered, so a widget is only touched
+// when what it shows actually changes. Widgets keep their text while their
+// screen is hidden, so the caches stay valid and loading a screen only
+// rewrites the values that moved since it was last visible.
+#define SHOWN_UNKNOWN INT32_MIN        // Widget text not known yet, always write
+#define VALUE_NONE    (INT32_MIN + 1)  // No data, shown as a placeholder
+
+static int32_t shownVoltStats[4][2];
+static int32_t shownResStats[4][2];
+static bool shownStale = false;
+static uint32_t resumedMs = 0;       // Samples are not counted as stale from before this, see update_bms_display_resumed()
+static uint32_t widgetWrites = 0;
+static uint32_t measuredSeq[BMS_MAX_DEVICES] = { 0 };  // Last sample reported for the latency figures
+
+static void reset_shown(int32_t *values, int count) {
+  for (int i = 0; i < count; i++) values[i] = SHOWN_UNKNOWN;
+}
+
+static bool changed(int32_t &shown, int32_t value) {
+  if (shown == value) return false;
+  shown = value;
+  widgetWrites++;
+  return true;
+}
+
+// Writes a thousandths value (mV, mOhm) as "1.234"
+static void table_set_milli(lv_obj_t *table, uint32_t row, uint32_t col, int32_t &shown, int32_t value, const char *none) {
+  if (!changed(shown, value)) return;
+  if (value == VALUE_NONE) {
+    lv_table_set_cell_value(table, row, col, none);
+  } else {
+    char text[16];
+    fixed_format(text, sizeof(text), value, 3, 3);
+    lv_table_set_cell_value(table, row, col, text);
   }
-  
-  // Update SOC gauge
-  if (soc_gauge && soc_gauge_label) {
-    if (connected) {
-      lv_arc_set_value(soc_gauge, connectedBMS->Percent_Remain);
-      lv_label_set_text_fmt(soc_gauge_label, "%d%%", connectedBMS->Percent_Remain);
-    } else {
-      lv_arc_set_value(soc_gauge, 0);
-      lv_label_set_text(soc_gauge_label, "0%");
-    }
+}
+
+static void table_set_int(lv_obj_t *table, uint32_t row, uint32_t col, int32_t &shown, int32_t value) {
+  if (!changed(shown, value)) return;
+  if (value == VALUE_NONE) {
+    lv_table_set_cell_value(table, row, col, "-");
+  } else {
+    char text[16];
+    int_format(text, sizeof(text), value);
+    lv_table_set_cell_value(table, row, col, text);
   }
+}
 
-  // Update voltage and current on main screen
-  if (battery_voltage_and_current_label) {
-    if (connected) {
-      battery_voltage = connectedBMS->Battery_Voltage;
-      battery_current = connectedBMS->Charge_Current;
-      lv_label_set_text_fmt(battery_voltage_and_current_label, "V: %.2f   A: %.3f", battery_voltage, battery_current);
-    } else {
-      lv_label_set_text(battery_voltage_and_current_label, "V: --.--   A: ---.---");
+// High/low/delta/average rows shared by the voltage and resistance screens
+static void update_stats_table(lv_obj_t *table, int32_t shown[4][2], const uint16_t *values, int count) {
+  int32_t high = VALUE_NONE, low = VALUE_NONE, high_idx = VALUE_NONE, low_idx = VALUE_NONE;
+  int32_t delta = VALUE_NONE, avg = VALUE_NONE;
+  if (values && count > 0) {
+    int32_t sum = 0;
+    high = -1; low = INT32_MAX;
+    for (int i = 0; i < count; i++) {
+      if (values[i] > high) { high = values[i]; high_idx = i + 1; }
+      if (values[i] < low)  { low = values[i];  low_idx = i + 1; }
+      sum += values[i];
     }
+    delta = high - low;
+    avg = sum / count;
   }
 
-  // Update delta voltage table
-  if (delta_voltages_table) {
-    if (connected) {
-      float high = -1000.0f, low = 1000.0f;
-      int high_idx = -1, low_idx = -1;
-      for (int i = 0; i < connectedBMS->cell_count; i++) {
-        float v = connectedBMS->cellVoltage[i];
-        if (v > high) { high = v; high_idx = i; }
-        if (v < low)  { low = v;  low_idx = i; }
-      }
+  table_set_milli(table, 1, 1, shown[0][0], high, "-");
+  table_set_int(table, 1, 2, shown[0][1], high_idx);
+  table_set_milli(table, 2, 1, shown[1][0], low, "-");
+  table_set_int(table, 2, 2, shown[1][1], low_idx);
+  table_set_milli(table, 3, 1, shown[2][0], delta, "-");
+  table_set_milli(table, 4, 1, shown[3][0], avg, "-");
+}
 
-      lv_table_set_cell_value_fmt(delta_voltages_table, 1, 1, "%.3f", high);
-      lv_table_set_cell_value_fmt(delta_voltages_table, 1, 2, "%d", high_idx + 1);
-      lv_table_set_cell_value_fmt(delta_voltages_table, 2, 1, "%.3f", low);
-      lv_table_set_cell_value_fmt(delta_voltages_table, 2, 2, "%d", low_idx + 1);
-      lv_table_set_cell_value_fmt(delta_voltages_table, 3, 1, "%.3f", connectedBMS->Delta_Cell_Voltage);
-      lv_table_set_cell_value_fmt(delta_voltages_table, 4, 1, "%.3f", connectedBMS->Average_Cell_Voltage);
-    } else {
-      lv_table_set_cell_value(delta_voltages_table, 1, 1, "-");
-      lv_table_set_cell_value(delta_voltages_table, 2, 1, "-");
-      lv_table_set_cell_value(delta_voltages_table, 3, 1, "-");
-      lv_table_set_cell_value(delta_voltages_table, 4, 1, "-");
-    }
-  }
-  
-  // Update cell voltage table
-  if (cell_voltage_table) {
-    if (connected) {
-      for (int i = 0; i < 16; i++) {
-        lv_table_set_cell_value_fmt(cell_voltage_table, i + 1, 1, "%.3f", connectedBMS->cellVoltage[i]);
-      }
-    } else {
-      for (int i = 0; i < 16; i++) {
-        lv_table_set_cell_value(cell_voltage_table, i + 1, 1, "0.000");
+// Rows to show in the cell bars, all 16 until a sample tells us the cell count
+static uint8_t bar_count(const TelemetrySample *sample) {
+  return sample && sample->cellCount ? sample->cellCount : 16;
+}
+
+// Update BMS display with the latest decoded sample
+// Only widgets on the active screen are updated; go_* functions call this
+// after loading a screen so it catches up once when it becomes visible.
+void update_bms_display_resumed() {
+  resumedMs = millis();
+}
+
+bool update_bms_display(uint32_t *rxUs) {
+  uint32_t writesBefore = widgetWrites;
+
+  // Detail screens follow the pack on the dashboard, or the first connected one
+  int slot = dashboard_selected_slot();
+  const UiPackInfo *pack = ui_pack(slot);
+  if (!pack || !pack->connected) {
+    for (int i = 0; i < BMS_MAX_DEVICES; i++) {
+      pack = ui_pack(i);
+      if (pack && pack->connected) {
+        slot = i;
+        break;
       }
     }
   }
+  const TelemetrySample *sample = pack && pack->connected ? ui_sample(slot) : nullptr;
+
+  // Flag data that stopped updating while the link is still up
+  // Age counts from the wake at the earliest, the UI took no samples while blanked
+  bool stale = false;
+  if (sample) {
+    uint32_t fromMs = (int32_t)(resumedMs - sample->timeMs) > 0 ? resumedMs : sample->timeMs;
+    stale = millis() - fromMs > DISPLAY_STALE_TIMEOUT;
+  }
+  if (lbl_stale && stale != shownStale) {
+    shownStale = stale;
+    if (stale) lv_obj_clear_flag(lbl_stale, LV_OBJ_FLAG_HIDDEN);
+    else lv_obj_add_flag(lbl_stale, LV_OBJ_FLAG_HIDDEN);
+    widgetWrites++;
+  }
 
-  // Update wire resistance high/low/average table
-  if (res_high_low_avg_table) {
-    if (connected) {
-      float high = -1000.0f, low = 1000.0f;
-      int high_idx = -1, low_idx = -1;
-      float sum_res = 0;
-      float avg_res = 0;
-      for (int i = 0; i < connectedBMS->cell_count; i++) {
-        float res = connectedBMS->wireResist[i];
-        if (res > high) { high = res; high_idx = i; }
-        if (res < low)  { low = res;  low_idx = i; }
-        sum_res += res;
-      }
-      avg_res = sum_res / connectedBMS->cell_count;
-
-      lv_table_set_cell_value_fmt(res_high_low_avg_table, 1, 1, "%.3f", high);
-      lv_table_set_cell_value_fmt(res_high_low_avg_table, 1, 2, "%d", high_idx + 1);
-      lv_table_set_cell_value_fmt(res_high_low_avg_table, 2, 1, "%.3f", low);
-      lv_table_set_cell_value_fmt(res_high_low_avg_table, 2, 2, "%d", low_idx + 1);
-      lv_table_set_cell_value_fmt(res_high_low_avg_table, 3, 1, "%.3f", high - low);
-      lv_table_set_cell_value_fmt(res_high_low_avg_table, 4, 1, "%.3f", avg_res);
-    } else {
-      lv_table_set_cell_value(res_high_low_avg_table, 1, 1, "-");
-      lv_table_set_cell_value(res_high_low_avg_table, 2, 1, "-");
-      lv_table_set_cell_value(res_high_low_avg_table, 3, 1, "-");
-      lv_table_set_cell_value(res_high_low_avg_table, 4, 1, "-");
+  lv_obj_t *active = lv_screen_active();
+
+  if (active == scr_main) {
+    // Only the pack on the visible carousel tile is updated
+    if (dashboard_update()) widgetWrites++;
+  } else if (active == scr_cell_voltages) {
+    // Update delta voltage table
+    if (delta_voltages_table) {
+      update_stats_table(delta_voltages_table, shownVoltStats, sample ? sample->cellMv : nullptr, sample ? sample->cellCount : 0);
+    }
+
+    // Update cell voltage bars, only changed rows are redrawn
+    if (cell_voltage_bars) {
+      if (cell_bars_set_values(cell_voltage_bars, sample ? sample->cellMv : nullptr, bar_count(sample))) widgetWrites++;
+    }
+  } else if (active == scr_cell_resistances) {
+    // Update wire resistance high/low/average table
+    if (res_high_low_avg_table) {
+      update_stats_table(res_high_low_avg_table, shownResStats, sample ? sample->wireResMOhm : nullptr, sample ? sample->cellCount : 0);
+    }
+
+    // Update wire resistance bars
+    if (wire_res_bars) {
+      if (cell_bars_set_values(wire_res_bars, sample ? sample->wireResMOhm : nullptr, bar_count(sample))) widgetWrites++;
     }
   }
-  
-  // Update wire resistance table
-  if (wire_res_table) {
-    if (connected) {
-      for (int i = 0; i < 16; i++) {
-        lv_table_set_cell_value_fmt(wire_res_table, i + 1, 1, "%.3f", connectedBMS->wireResist[i]);
-      }
-    } else {
-      for (int i = 0; i < 16; i++) {
-        lv_table_set_cell_value(wire_res_table, i + 1, 1, "-");
-      }
+
+  if (widgetWrites == writesBefore) return false;
+  // Only a sample reaching the screen for the first time has a receive-to-pixels
+  // latency; redraws of an old one (e.g. the stale flag) don't count
+  if (rxUs) {
+    *rxUs = 0;
+    if (sample && sample->seq != measuredSeq[slot]) {
+      measuredSeq[slot] = sample->seq;
+      *rxUs = sample->rxUs;
     }
   }
+  return true;
 }
 
+// Screen-off choices on the backlight screen, ms (0 = never)
+static const uint32_t blank_timeouts[] = { 0, 60000, 300000, 900000, 3600000 };
+static const char *blank_timeout_options = "Never\n1 min\n5 min\n15 min\n1 h";
+
 // Backlight brightness screen
 void go_backlight() {
   if (!scr_backlight) {
+    screen_cache_building(SCREEN_BL);
     scr_backlight = new_screen(NULL);
 
+    // Levels live in the idle manager, the screen may have been evicted and rebuilt
     slider_bl = lv_slider_create(scr_backlight);
     lv_obj_set_width(slider_bl, lv_pct(80));
     lv_slider_set_range(slider_bl, 0, 255);
+    lv_slider_set_value(slider_bl, idle_brightness(), LV_ANIM_OFF);
     lv_obj_add_event_cb(slider_bl, [](lv_event_t *e) -> void {
-      LVGL_CYD::backlight(lv_slider_get_value(slider_bl));
+      idle_set_brightness(lv_slider_get_value(slider_bl));
     }, LV_EVENT_VALUE_CHANGED, NULL);
 
-    // Turn on backlight initially
-    lv_slider_set_value(slider_bl, 255, LV_ANIM_OFF);
+    lv_obj_t *chb_auto = lv_checkbox_create(scr_backlight);
+    lv_checkbox_set_text(chb_auto, "Auto brightness (light sensor)");
+    if (idle_auto_brightness()) lv_obj_add_state(chb_auto, LV_STATE_CHECKED);
+    lv_obj_add_event_cb(chb_auto, [](lv_event_t *e) -> void {
+      idle_set_auto_brightness(lv_obj_has_state(lv_event_get_target_obj(e), LV_STATE_CHECKED));
+    }, LV_EVENT_VALUE_CHANGED, NULL);
 
-    // Set backlight to initial slider value
-    LVGL_CYD::backlight(lv_slider_get_value(slider_bl));
+    lv_obj_t *lbl_timeout = lv_label_create(scr_backlight);
+    lv_label_set_text(lbl_timeout, "Screen off after");
+    lv_obj_t *dd_timeout = lv_dropdown_create(scr_backlight);
+    lv_dropdown_set_options_static(dd_timeout, blank_timeout_options);
+    for (uint32_t i = 0; i < sizeof(blank_timeouts) / sizeof(blank_timeouts[0]); i++) {
+      if (blank_timeouts[i] == idle_blank_timeout()) lv_dropdown_set_selected(dd_timeout, i);
+    }
+    lv_obj_add_event_cb(dd_timeout, [](lv_event_t *e) -> void {
+      idle_set_blank_timeout(blank_timeouts[lv_dropdown_get_selected(lv_event_get_target_obj(e))]);
+    }, LV_EVENT_VALUE_CHANGED, NULL);
   }
 
   lv_label_set_text(lbl_header, "Backlight brightness");
   lv_obj_clear_flag(btn_back, LV_OBJ_FLAG_HIDDEN);
   lv_obj_clear_flag(btn_exit, LV_OBJ_FLAG_HIDDEN);
-  lv_screen_load(scr_backlight);
+  screen_cache_show(SCREEN_BL);
 }
 
 // Rotate display 90 degrees clockwise
@@ -209,6 +267,7 @@ void go_rotate() {
 // Misc settings screen
 void go_display_settings() {
   if (!scr_display_settings) {
+    screen_cache_building(SCREEN_DISPLAY_SETTINGS);
     scr_display_settings = new_screen(NULL);
     lv_obj_set_size(scr_display_settings, lv_disp_get_hor_res(NULL), lv_disp_get_ver_res(NULL));
 
@@ -231,226 +290,207 @@ void go_display_settings() {
   lv_label_set_text(lbl_header, "Misc Settings");
   lv_obj_clear_flag(btn_back, LV_OBJ_FLAG_HIDDEN);
   lv_obj_clear_flag(btn_exit, LV_OBJ_FLAG_HIDDEN);
-  lv_screen_load(scr_display_settings);
+  screen_cache_show(SCREEN_DISPLAY_SETTINGS);
+}
+
+// Builds without showing, also used by the prebuilder
+static void build_settings() {
+  screen_cache_building(SCREEN_SETTINGS);
+  scr_settings = new_screen(NULL);
+  lv_obj_set_size(scr_settings, lv_disp_get_hor_res(NULL), lv_disp_get_ver_res(NULL));
+
+  lv_obj_t *btn_misc_settings = lv_button_create(scr_settings);
+  lv_obj_t *lbl_display_settings = lv_label_create(btn_misc_settings);
+  lv_label_set_text(lbl_display_settings, "Display Settings");
+  lv_obj_add_event_cb(btn_misc_settings, [](lv_event_t *e) -> void {
+    nav_push(ScreenID::SCREEN_SETTINGS);
+    go_display_settings();
+  }, LV_EVENT_CLICKED, NULL);
+
+  lv_obj_t *btn_diagnostics = lv_button_create(scr_settings);
+  lv_obj_t *lbl_diagnostics = lv_label_create(btn_diagnostics);
+  lv_label_set_text(lbl_diagnostics, "Diagnostics");
+  lv_obj_add_event_cb(btn_diagnostics, [](lv_event_t *e) -> void {
+    nav_push(ScreenID::SCREEN_SETTINGS);
+    go_diagnostics();
+  }, LV_EVENT_CLICKED, NULL);
+
+  // TODO: Implement checkbox state 
+  //TODO: set as option for individual BMSes ??
+  lv_obj_t *chb_bms_auto_conn_on_boot = lv_checkbox_create(scr_settings);
+  lv_checkbox_set_text(chb_bms_auto_conn_on_boot, "Auto conn BMS on boot");
 }
 
 // Settings screen
 void go_settings() {
-  if (!scr_settings) {
-    scr_settings = new_screen(NULL);
-    lv_obj_set_size(scr_settings, lv_disp_get_hor_res(NULL), lv_disp_get_ver_res(NULL));
-
-    lv_obj_t *btn_misc_settings = lv_button_create(scr_settings);
-    lv_obj_t *lbl_display_settings = lv_label_create(btn_misc_settings);
-    lv_label_set_text(lbl_display_settings, "Display Settings");
-    lv_obj_add_event_cb(btn_misc_settings, [](lv_event_t *e) -> void {
-      nav_push(ScreenID::SCREEN_SETTINGS);
-      go_display_settings();
-    }, LV_EVENT_CLICKED, NULL);
-
-    // TODO: Implement checkbox state 
-    //TODO: set as option for individual BMSes ??
-    lv_obj_t *chb_bms_auto_conn_on_boot = lv_checkbox_create(scr_settings);
-    lv_checkbox_set_text(chb_bms_auto_conn_on_boot, "Auto conn BMS on boot");
-  }
+  if (!scr_settings) build_settings();
 
   lv_label_set_text(lbl_header, "Settings");
   lv_obj_clear_flag(btn_back, LV_OBJ_FLAG_HIDDEN);
   lv_obj_clear_flag(btn_exit, LV_OBJ_FLAG_HIDDEN);
-  lv_screen_load(scr_settings);
+  screen_cache_show(SCREEN_SETTINGS);
 }
 
-// Wire resistances screen
-void go_wire_resistances() {
-  if (!scr_cell_resistances) {
-    scr_cell_resistances = lv_obj_create(NULL);
-    lv_obj_set_style_bg_opa(scr_cell_resistances, LV_OPA_TRANSP, LV_PART_MAIN);
-    lv_obj_set_style_border_width(scr_cell_resistances, 0, 0);
-    lv_obj_set_size(scr_cell_resistances, lv_disp_get_hor_res(NULL), lv_disp_get_ver_res(NULL));
-
-    // Create scrollable container
-    lv_obj_t *scroll_container = lv_obj_create(scr_cell_resistances);
-    lv_obj_set_size(scroll_container, lv_pct(100), lv_pct(100));
-    lv_obj_set_style_pad_all(scroll_container, 10, LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(scroll_container, LV_OPA_TRANSP, LV_PART_MAIN);
-    lv_obj_set_style_border_width(scroll_container, 0, 0);
-    lv_obj_set_layout(scroll_container, LV_LAYOUT_FLEX);
-    lv_obj_set_flex_flow(scroll_container, LV_FLEX_FLOW_COLUMN);
-
-    // Create table for high/low resistances
-    res_high_low_avg_table = lv_table_create(scroll_container);
-    lv_obj_set_size(res_high_low_avg_table, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
-
-    int num_rows = 5; // Header + 4 rows
-    int num_cols = 3; // Description, Resistance, Cell#
-
-    lv_table_set_column_count(res_high_low_avg_table, num_cols);
-    lv_table_set_row_count(res_high_low_avg_table, num_rows);
-
-    lv_table_set_column_width(res_high_low_avg_table, 0, 100);
-    lv_table_set_column_width(res_high_low_avg_table, 1, 100);
-    lv_table_set_column_width(res_high_low_avg_table, 2, 100);
-
-    lv_table_set_cell_value(res_high_low_avg_table, 0, 1, "Res.");
-    lv_table_set_cell_value(res_high_low_avg_table, 0, 2, "Cell#");
-
-    lv_table_set_cell_value(res_high_low_avg_table, 1, 0, "High_Res.");
-    lv_table_set_cell_value(res_high_low_avg_table, 2, 0, "Low_Res.");
-    lv_table_set_cell_value(res_high_low_avg_table, 3, 0, "Delta_Res.");
-    lv_table_set_cell_value(res_high_low_avg_table, 4, 0, "Avg_Res.");
-
-    lv_obj_set_style_bg_color(res_high_low_avg_table, lv_color_hex(0xE0E0E0), static_cast<lv_style_selector_t>(LV_PART_ITEMS) | static_cast<lv_style_selector_t>(LV_STATE_DEFAULT));
-    lv_obj_set_style_text_font(res_high_low_avg_table, &lv_font_montserrat_14, LV_PART_ITEMS);
-
-    for (int r = 1; r < num_rows; r++) {
-      lv_table_set_cell_value(res_high_low_avg_table, r, 1, "-");
-      lv_table_set_cell_value(res_high_low_avg_table, r, 2, "-");
-    }
+// Builds without showing, also used by the prebuilder
+static void build_wire_resistances() {
+  screen_cache_building(SCREEN_CELL_RESISTANCES);
+  scr_cell_resistances = lv_obj_create(NULL);
+  lv_obj_add_style(scr_cell_resistances, &style_transparent, LV_PART_MAIN);
+  lv_obj_set_size(scr_cell_resistances, lv_disp_get_hor_res(NULL), lv_disp_get_ver_res(NULL));
 
-    // Create table for wire resistances
-    wire_res_table = lv_table_create(scroll_container);
-    lv_obj_set_size(wire_res_table, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
+  // Create scrollable container
+  lv_obj_t *scroll_container = lv_obj_create(scr_cell_resistances);
+  lv_obj_set_size(scroll_container, lv_pct(100), lv_pct(100));
+  lv_obj_add_style(scroll_container, &style_transparent, LV_PART_MAIN);
+  lv_obj_add_style(scroll_container, &style_container, LV_PART_MAIN);
+  lv_obj_set_layout(scroll_container, LV_LAYOUT_FLEX);
+  lv_obj_set_flex_flow(scroll_container, LV_FLEX_FLOW_COLUMN);
 
-    lv_table_set_column_count(wire_res_table, 2);
-    lv_table_set_row_count(wire_res_table, 17); // Header + 16 cells
+  // Create table for high/low resistances
+  res_high_low_avg_table = lv_table_create(scroll_container);
+  lv_obj_set_size(res_high_low_avg_table, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
 
-    lv_table_set_column_width(wire_res_table, 0, 80);
-    lv_table_set_column_width(wire_res_table, 1, 100);
+  int num_rows = 5; // Header + 4 rows
+  int num_cols = 3; // Description, Resistance, Cell#
 
-    lv_table_set_cell_value(wire_res_table, 0, 0, "Cell");
-    lv_table_set_cell_value(wire_res_table, 0, 1, "Res.");
+  lv_table_set_column_count(res_high_low_avg_table, num_cols);
+  lv_table_set_row_count(res_high_low_avg_table, num_rows);
 
-    lv_obj_set_style_bg_color(wire_res_table, lv_color_hex(0xE0E0E0), static_cast<lv_style_selector_t>(LV_PART_ITEMS) | static_cast<lv_style_selector_t>(LV_STATE_DEFAULT));
-    lv_obj_set_style_text_font(wire_res_table, &lv_font_montserrat_14, LV_PART_ITEMS);
+  lv_table_set_column_width(res_high_low_avg_table, 0, 100);
+  lv_table_set_column_width(res_high_low_avg_table, 1, 100);
+  lv_table_set_column_width(res_high_low_avg_table, 2, 100);
 
-    for (int i = 1; i <= 16; i++) {
-      lv_table_set_cell_value_fmt(wire_res_table, i, 0, "%d", i);
-      lv_table_set_cell_value(wire_res_table, i, 1, "");
-    }
+  lv_table_set_cell_value(res_high_low_avg_table, 0, 1, "Res.");
+  lv_table_set_cell_value(res_high_low_avg_table, 0, 2, "Cell#");
+
+  lv_table_set_cell_value(res_high_low_avg_table, 1, 0, "High_Res.");
+  lv_table_set_cell_value(res_high_low_avg_table, 2, 0, "Low_Res.");
+  lv_table_set_cell_value(res_high_low_avg_table, 3, 0, "Delta_Res.");
+  lv_table_set_cell_value(res_high_low_avg_table, 4, 0, "Avg_Res.");
+
+  lv_obj_add_style(res_high_low_avg_table, &style_table_items, LV_PART_ITEMS);
+
+  for (int r = 1; r < num_rows; r++) {
+    lv_table_set_cell_value(res_high_low_avg_table, r, 1, "-");
+    lv_table_set_cell_value(res_high_low_avg_table, r, 2, "-");
   }
 
+  // One bar per cell, scaled between the lowest and highest resistance
+  wire_res_bars = cell_bars_create(scroll_container, 16);
+  reset_shown(&shownResStats[0][0], 8);
+}
+
+// Wire resistances screen
+void go_wire_resistances() {
+  if (!scr_cell_resistances) build_wire_resistances();
+
   lv_label_set_text(lbl_header, "Wire Resistances");
   lv_obj_clear_flag(btn_back, LV_OBJ_FLAG_HIDDEN);
   lv_obj_clear_flag(btn_exit, LV_OBJ_FLAG_HIDDEN);
-  lv_screen_load(scr_cell_resistances);
+  screen_cache_show(SCREEN_CELL_RESISTANCES);
+  update_bms_display();
 }
 
-// Cell voltages screen
-void go_cell_voltages() {
-  if (!scr_cell_voltages) {
-    scr_cell_voltages = lv_obj_create(NULL);
-    lv_obj_set_style_bg_opa(scr_cell_voltages, LV_OPA_TRANSP, LV_PART_MAIN);
-    lv_obj_set_style_border_width(scr_cell_voltages, 0, 0);
-    lv_obj_set_size(scr_cell_voltages, lv_disp_get_hor_res(NULL), lv_disp_get_ver_res(NULL));
-
-    // Create scrollable container
-    lv_obj_t *scroll_container = lv_obj_create(scr_cell_voltages);
-    lv_obj_set_size(scroll_container, lv_pct(100), lv_pct(100));
-    lv_obj_set_style_pad_all(scroll_container, 10, LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(scroll_container, LV_OPA_TRANSP, LV_PART_MAIN);
-    lv_obj_set_style_border_width(scroll_container, 0, 0);
-    lv_obj_set_layout(scroll_container, LV_LAYOUT_FLEX);
-    lv_obj_set_flex_flow(scroll_container, LV_FLEX_FLOW_COLUMN);
-
-    // Create table for high/low voltages
-    delta_voltages_table = lv_table_create(scroll_container);
-    lv_obj_set_size(delta_voltages_table, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
-
-    int num_rows = 5; // Header + 4 rows
-    int num_cols = 3; // Description, Voltage, Cell#
-
-    lv_table_set_column_count(delta_voltages_table, num_cols);
-    lv_table_set_row_count(delta_voltages_table, num_rows);
-
-    lv_table_set_column_width(delta_voltages_table, 0, 100);
-    lv_table_set_column_width(delta_voltages_table, 1, 100);
-    lv_table_set_column_width(delta_voltages_table, 2, 100);
-
-    lv_table_set_cell_value(delta_voltages_table, 0, 1, "Voltage");
-    lv_table_set_cell_value(delta_voltages_table, 0, 2, "Cell#");
-
-    lv_table_set_cell_value(delta_voltages_table, 1, 0, "High_V");
-    lv_table_set_cell_value(delta_voltages_table, 2, 0, "Low_V");
-    lv_table_set_cell_value(delta_voltages_table, 3, 0, "Delta_V");
-    lv_table_set_cell_value(delta_voltages_table, 4, 0, "Avg_V");
-
-    lv_obj_set_style_bg_color(delta_voltages_table, lv_color_hex(0xE0E0E0), static_cast<lv_style_selector_t>(LV_PART_ITEMS) | static_cast<lv_style_selector_t>(LV_STATE_DEFAULT));
-    lv_obj_set_style_text_font(delta_voltages_table, &lv_font_montserrat_14, LV_PART_ITEMS);
-
-    for (int r = 1; r < num_rows; r++) {
-      lv_table_set_cell_value(delta_voltages_table, r, 1, "-");
-      lv_table_set_cell_value(delta_voltages_table, r, 2, "-");
-    }
+// Builds without showing, also used by the prebuilder
+static void build_cell_voltages() {
+  screen_cache_building(SCREEN_CELL_VOLTAGES);
+  scr_cell_voltages = lv_obj_create(NULL);
+  lv_obj_add_style(scr_cell_voltages, &style_transparent, LV_PART_MAIN);
+  lv_obj_set_size(scr_cell_voltages, lv_disp_get_hor_res(NULL), lv_disp_get_ver_res(NULL));
 
-    // Create table for cell voltages
-    cell_voltage_table = lv_table_create(scroll_container);
-    lv_obj_set_size(cell_voltage_table, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
+  // Create scrollable container
+  lv_obj_t *scroll_container = lv_obj_create(scr_cell_voltages);
+  lv_obj_set_size(scroll_container, lv_pct(100), lv_pct(100));
+  lv_obj_add_style(scroll_container, &style_transparent, LV_PART_MAIN);
+  lv_obj_add_style(scroll_container, &style_container, LV_PART_MAIN);
+  lv_obj_set_layout(scroll_container, LV_LAYOUT_FLEX);
+  lv_obj_set_flex_flow(scroll_container, LV_FLEX_FLOW_COLUMN);
 
-    lv_table_set_column_count(cell_voltage_table, 2);
-    lv_table_set_row_count(cell_voltage_table, 17); // Header + 16 cells
+  // Create table for high/low voltages
+  delta_voltages_table = lv_table_create(scroll_container);
+  lv_obj_set_size(delta_voltages_table, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
 
-    lv_table_set_column_width(cell_voltage_table, 0, 80);
-    lv_table_set_column_width(cell_voltage_table, 1, 100);
+  int num_rows = 5; // Header + 4 rows
+  int num_cols = 3; // Description, Voltage, Cell#
 
-    lv_table_set_cell_value(cell_voltage_table, 0, 0, "Cell");
-    lv_table_set_cell_value(cell_voltage_table, 0, 1, "Voltage (V)");
+  lv_table_set_column_count(delta_voltages_table, num_cols);
+  lv_table_set_row_count(delta_voltages_table, num_rows);
 
-    lv_obj_set_style_bg_color(cell_voltage_table, lv_color_hex(0xE0E0E0), static_cast<lv_style_selector_t>(LV_PART_ITEMS) | static_cast<lv_style_selector_t>(LV_STATE_DEFAULT));
-    lv_obj_set_style_text_font(cell_voltage_table, &lv_font_montserrat_14, LV_PART_ITEMS);
+  lv_table_set_column_width(delta_voltages_table, 0, 100);
+  lv_table_set_column_width(delta_voltages_table, 1, 100);
+  lv_table_set_column_width(delta_voltages_table, 2, 100);
 
-    for (int i = 1; i <= 16; i++) {
-      lv_table_set_cell_value_fmt(cell_voltage_table, i, 0, "%d", i);
-      lv_table_set_cell_value(cell_voltage_table, i, 1, "0.000");
-    }
+  lv_table_set_cell_value(delta_voltages_table, 0, 1, "Voltage");
+  lv_table_set_cell_value(delta_voltages_table, 0, 2, "Cell#");
+
+  lv_table_set_cell_value(delta_voltages_table, 1, 0, "High_V");
+  lv_table_set_cell_value(delta_voltages_table, 2, 0, "Low_V");
+  lv_table_set_cell_value(delta_voltages_table, 3, 0, "Delta_V");
+  lv_table_set_cell_value(delta_voltages_table, 4, 0, "Avg_V");
+
+  lv_obj_add_style(delta_voltages_table, &style_table_items, LV_PART_ITEMS);
+
+  for (int r = 1; r < num_rows; r++) {
+    lv_table_set_cell_value(delta_voltages_table, r, 1, "-");
+    lv_table_set_cell_value(delta_voltages_table, r, 2, "-");
   }
 
+  // One bar per cell, scaled between the lowest and highest voltage
+  cell_voltage_bars = cell_bars_create(scroll_container, 16);
+  reset_shown(&shownVoltStats[0][0], 8);
+}
+
+// Cell voltages screen
+void go_cell_voltages() {
+  if (!scr_cell_voltages) build_cell_voltages();
+
   lv_label_set_text(lbl_header, "Cell Voltages");
   lv_obj_clear_flag(btn_back, LV_OBJ_FLAG_HIDDEN);
   lv_obj_clear_flag(btn_exit, LV_OBJ_FLAG_HIDDEN);
-  lv_screen_load(scr_cell_voltages);
-}
-
-void save_mac_addr(const char *mac_addr) {
-  // TODO: add prefs logic here to save mac address
+  screen_cache_show(SCREEN_CELL_VOLTAGES);
+  update_bms_display();
 }
 
+// Asks the BMS task to register and save the device; it then connects it by address
 void connect_selected_device(const char *mac) {
   DEBUG_PRINTF("Connecting to device with MAC: %s\n", mac);
-  // TODO: Add code to connect to the device using the provided MAC address
-  // TODO: read from prefs on startup if any mac addresses are saved to prefs
+  bms_post_command(BMS_CMD_ADD_DEVICE, mac);
+}
+
+// Asks the BMS task to remove the device from the registry and from Preferences
+void forget_device(const char *mac) {
+  DEBUG_PRINTF("Forgetting device with MAC: %s\n", mac);
+  bms_post_command(BMS_CMD_FORGET_DEVICE, mac);
 }
 
 // Adds a button to the device list for the given device info
 // Returns the button object created
-lv_obj_t *create_device_list_button(const char *name, const char *mac_address) {
+lv_obj_t *create_device_list_button(const char *name, const char *mac_address, int rssi) {
   if (jk_devices_scroll_container) {
     DEBUG_PRINTLN("Adding button...");
 
     lv_obj_t *btn = lv_btn_create(jk_devices_scroll_container);
     //lv_obj_remove_style_all(btn);
     lv_obj_set_size(btn, lv_pct(100), LV_SIZE_CONTENT);
-    lv_obj_set_style_pad_all(btn, 4, 0);
+    lv_obj_add_style(btn, &style_device_row, LV_PART_MAIN);
 
     // set button to flex row so labels are side by side
     lv_obj_set_layout(btn, LV_LAYOUT_FLEX);
     lv_obj_set_flex_flow(btn, LV_FLEX_FLOW_ROW);
     
+    // Child order (name, MAC, RSSI) is relied on by update_device_list_button()
     lv_obj_t *name_lbl = lv_label_create(btn);
     lv_label_set_text(name_lbl, name);
-    //lv_obj_set_grid_cell(name_lbl, LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_CENTER, 0, 1);
-    
-    //lv_obj_t *rssi_lbl = lv_label_create(btn);
-    //lv_label_set_text(rssi_lbl, rssi);
-    //lv_obj_set_grid_cell(rssi_lbl, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_CENTER, 1, 1);
     
     lv_obj_t *mac_lbl = lv_label_create(btn);
     lv_label_set_text(mac_lbl, mac_address);
-    //lv_obj_set_grid_cell(mac_lbl, LV_GRID_ALIGN_START, 2, 1, LV_GRID_ALIGN_CENTER, 2, 1);
 
-    lv_obj_set_style_pad_column(btn, 10, 0);
+    lv_obj_t *rssi_lbl = lv_label_create(btn);
+    lv_label_set_text_fmt(rssi_lbl, "%d dBm", rssi);
 
     // allocate a copy of the MAC address on the heap
     char *mac_copy = strdup(mac_address);
+    lv_obj_set_user_data(btn, mac_copy);
     
     //lv_obj_add_style(btn, &style_btn, 0);
     //lv_obj_add_style(btn, &style_button_pr, LV_STATE_PRESSED);
@@ -462,11 +502,22 @@ lv_obj_t *create_device_list_button(const char *name, const char *mac_address) {
       const char *mac = static_cast<const char*>(lv_event_get_user_data(e));
       if(mac) {
         DEBUG_PRINTF("Button clicked for device with MAC: %s\n", mac);
-        //connect_selected_device(mac);
+        connect_selected_device(mac);
       } else {
         DEBUG_PRINTLN("Button clicked but MAC address is NULL!");
       }
-    }, LV_EVENT_CLICKED, mac_copy); // pass the MAC address copy as user data
+    }, LV_EVENT_SHORT_CLICKED, mac_copy); // pass the MAC address copy as user data
+
+    // Long press forgets a saved device
+    lv_obj_add_event_cb(btn, [](lv_event_t *e) -> void {
+      const char *mac = static_cast<const char*>(lv_event_get_user_data(e));
+      if(mac) forget_device(mac);
+    }, LV_EVENT_LONG_PRESSED, mac_copy);
+
+    // The row goes away with the screen when it is evicted, free the MAC copy with it
+    lv_obj_add_event_cb(btn, [](lv_event_t *e) -> void {
+      free(lv_event_get_user_data(e));
+    }, LV_EVENT_DELETE, mac_copy);
     DEBUG_PRINTLN("Added device button to list!");
     return btn;
   } else {
@@ -475,6 +526,47 @@ lv_obj_t *create_device_list_button(const char *name, const char *mac_address) {
   return nullptr;
 }
 
+// Refreshes the row of an already listed device
+// Returns false if the device isn't in the list yet
+bool update_device_list_button(const char *name, const char *mac_address, int rssi) {
+  if (!jk_devices_scroll_container) return false;
+
+  uint32_t count = lv_obj_get_child_count(jk_devices_scroll_container);
+  for (uint32_t i = 0; i < count; i++) {
+    lv_obj_t *btn = lv_obj_get_child(jk_devices_scroll_container, i);
+    const char *mac = static_cast<const char*>(lv_obj_get_user_data(btn));
+    if (!mac || strcasecmp(mac, mac_address) != 0) continue;
+
+    // Only touch labels whose text changed so an unchanged row isn't redrawn
+    lv_obj_t *name_lbl = lv_obj_get_child(btn, 0);
+    if (name[0] && strcmp(lv_label_get_text(name_lbl), name) != 0) lv_label_set_text(name_lbl, name);
+
+    char rssi_text[12];
+    snprintf(rssi_text, sizeof(rssi_text), "%d dBm", rssi);
+    lv_obj_t *rssi_lbl = lv_obj_get_child(btn, 2);
+    if (strcmp(lv_label_get_text(rssi_lbl), rssi_text) != 0) lv_label_set_text(rssi_lbl, rssi_text);
+    return true;
+  }
+  return false;
+}
+
+// Shows a message box over the current screen
+// A second alert while one is open replaces its text instead of stacking boxes
+void show_alert(const char *title, const char *text) {
+  static lv_obj_t *alert_box = nullptr;
+
+  DEBUG_PRINTF("Alert: %s: %s\n", title, text);
+  if (alert_box) lv_msgbox_close(alert_box);
+
+  alert_box = lv_msgbox_create(NULL);
+  lv_msgbox_add_title(alert_box, title);
+  lv_msgbox_add_text(alert_box, text);
+  lv_obj_t *close_btn = lv_msgbox_add_close_button(alert_box);
+  lv_obj_add_event_cb(close_btn, [](lv_event_t *e) -> void {
+    alert_box = nullptr;
+  }, LV_EVENT_CLICKED, NULL);
+}
+
 // a test functiuon to add static buttons to the list
 // for testing the UI without needing to scan for devices
 // TODO: convert this to a real function that scans for devices
@@ -482,7 +574,7 @@ lv_obj_t *create_device_list_button(const char *name, const char *mac_address) {
 void add_button_to_list() {
   if (jk_devices_scroll_container) {
     DEBUG_PRINTLN("Adding button...");
-    create_device_list_button("JK BMS", "AA:BB:CC:DD:EE:FF");
+    create_device_list_button("JK BMS", "AA:BB:CC:DD:EE:FF", 0);
     lv_obj_scroll_to_y(jk_devices_scroll_container, lv_obj_get_height(jk_devices_scroll_container), LV_ANIM_ON);
     lv_obj_update_layout(jk_devices_scroll_container);
   } else {
@@ -494,6 +586,7 @@ void add_button_to_list() {
 // screen for selecting and connecting to JK BMS devices
 void go_connect_bms() {
   if(!scr_connect_jk_device) {
+    screen_cache_building(SCREEN_CONNECT_JK_DEVICE);
     scr_connect_jk_device = new_screen(NULL);
     lv_obj_set_size(scr_connect_jk_device, lv_disp_get_hor_res(NULL), lv_disp_get_ver_res(NULL));
 
@@ -504,7 +597,7 @@ void go_connect_bms() {
     lv_obj_add_event_cb(scan_btn, [](lv_event_t *e) -> void {
       //scan_for_jk_devices();
       DEBUG_PRINTLN("Scan button pressed!");
-      scanForDevices();
+      bms_post_command(BMS_CMD_START_SCAN);
     }, LV_EVENT_CLICKED, NULL);
 
     lv_obj_t *scan_btn_label = lv_label_create(scan_btn);
@@ -514,9 +607,8 @@ void go_connect_bms() {
     // Create scrollable container for device list
     jk_devices_scroll_container = lv_obj_create(scr_connect_jk_device);
     lv_obj_set_size(jk_devices_scroll_container, lv_pct(100), lv_pct(100));
-    lv_obj_set_style_pad_all(jk_devices_scroll_container, 10, LV_PART_MAIN);
-    lv_obj_set_style_bg_opa(jk_devices_scroll_container, LV_OPA_TRANSP, LV_PART_MAIN);
-    lv_obj_set_style_border_width(jk_devices_scroll_container, 0, 0);
+    lv_obj_add_style(jk_devices_scroll_container, &style_transparent, LV_PART_MAIN);
+    lv_obj_add_style(jk_devices_scroll_container, &style_container, LV_PART_MAIN);
     lv_obj_set_layout(jk_devices_scroll_container, LV_LAYOUT_FLEX);
     lv_obj_set_flex_flow(jk_devices_scroll_container, LV_FLEX_FLOW_COLUMN);
     lv_obj_set_flex_grow(jk_devices_scroll_container, 1);
@@ -526,76 +618,93 @@ void go_connect_bms() {
   lv_label_set_text(lbl_header, "Choose Device");
   lv_obj_clear_flag(btn_back, LV_OBJ_FLAG_HIDDEN);
   lv_obj_clear_flag(btn_exit, LV_OBJ_FLAG_HIDDEN);
-  lv_screen_load(scr_connect_jk_device);
+  screen_cache_show(SCREEN_CONNECT_JK_DEVICE);
 }
 
-void go_more() {
-  if (!scr_more) {
-    scr_more = new_screen(NULL);
-    lv_obj_set_size(scr_more, lv_disp_get_hor_res(NULL), lv_disp_get_ver_res(NULL));
-
-    // Add connect BMS button
-    lv_obj_t *connect_bms_btn = lv_btn_create(scr_more);
-    lv_obj_set_size(connect_bms_btn, 120, 40);
-    lv_obj_align(connect_bms_btn, LV_ALIGN_BOTTOM_MID, 0, -20);
-    lv_obj_add_event_cb(connect_bms_btn, [](lv_event_t *e) -> void {
-      nav_push(ScreenID::SCREEN_MORE);
-      go_connect_bms();
-    }, LV_EVENT_CLICKED, NULL);
+// Builds without showing, also used by the prebuilder
+static void build_more() {
+  screen_cache_building(SCREEN_MORE);
+  scr_more = new_screen(NULL);
+  lv_obj_set_size(scr_more, lv_disp_get_hor_res(NULL), lv_disp_get_ver_res(NULL));
+
+  // Add connect BMS button
+  lv_obj_t *connect_bms_btn = lv_btn_create(scr_more);
+  lv_obj_set_size(connect_bms_btn, 120, 40);
+  lv_obj_align(connect_bms_btn, LV_ALIGN_BOTTOM_MID, 0, -20);
+  lv_obj_add_event_cb(connect_bms_btn, [](lv_event_t *e) -> void {
+    nav_push(ScreenID::SCREEN_MORE);
+    go_connect_bms();
+  }, LV_EVENT_CLICKED, NULL);
 
-    lv_obj_t *connect_bms_btn_label = lv_label_create(connect_bms_btn);
-    lv_label_set_text(connect_bms_btn_label, "Scan devices");
-    lv_obj_center(connect_bms_btn_label);
+  lv_obj_t *connect_bms_btn_label = lv_label_create(connect_bms_btn);
+  lv_label_set_text(connect_bms_btn_label, "Scan devices");
+  lv_obj_center(connect_bms_btn_label);
+
+  // Add cell voltages button
+  lv_obj_t *cell_voltages_btn = lv_btn_create(scr_more);
+  lv_obj_set_size(cell_voltages_btn, 120, 40);
+  lv_obj_align(cell_voltages_btn, LV_ALIGN_BOTTOM_MID, 0, -20);
+  lv_obj_add_event_cb(cell_voltages_btn, [](lv_event_t *e) -> void {
+    nav_push(ScreenID::SCREEN_MORE);
+    go_cell_voltages();
+  }, LV_EVENT_CLICKED, NULL);
 
-    // Add cell voltages button
-    lv_obj_t *cell_voltages_btn = lv_btn_create(scr_more);
-    lv_obj_set_size(cell_voltages_btn, 120, 40);
-    lv_obj_align(cell_voltages_btn, LV_ALIGN_BOTTOM_MID, 0, -20);
-    lv_obj_add_event_cb(cell_voltages_btn, [](lv_event_t *e) -> void {
-      nav_push(ScreenID::SCREEN_MORE);
-      go_cell_voltages();
-    }, LV_EVENT_CLICKED, NULL);
+  lv_obj_t *cell_voltages_btn_label = lv_label_create(cell_voltages_btn);
+  lv_label_set_text(cell_voltages_btn_label, "Cell Voltages");
+  lv_obj_center(cell_voltages_btn_label);
+
+  // Add wire resistances button
+  lv_obj_t *wire_res_button = lv_btn_create(scr_more);
+  lv_obj_set_size(wire_res_button, 120, 40);
+  lv_obj_align(wire_res_button, LV_ALIGN_BOTTOM_MID, 0, -20);
+  lv_obj_add_event_cb(wire_res_button, [](lv_event_t *e) -> void {
+    nav_push(ScreenID::SCREEN_MORE);
+    go_wire_resistances();
+  }, LV_EVENT_CLICKED, NULL);
 
-    lv_obj_t *cell_voltages_btn_label = lv_label_create(cell_voltages_btn);
-    lv_label_set_text(cell_voltages_btn_label, "Cell Voltages");
-    lv_obj_center(cell_voltages_btn_label);
+  lv_obj_t *wire_res_button_label = lv_label_create(wire_res_button);
+  lv_label_set_text(wire_res_button_label, "Wire Res.");
+  lv_obj_center(wire_res_button_label);
 
-    // Add wire resistances button
-    lv_obj_t *wire_res_button = lv_btn_create(scr_more);
-    lv_obj_set_size(wire_res_button, 120, 40);
-    lv_obj_align(wire_res_button, LV_ALIGN_BOTTOM_MID, 0, -20);
-    lv_obj_add_event_cb(wire_res_button, [](lv_event_t *e) -> void {
-      nav_push(ScreenID::SCREEN_MORE);
-      go_wire_resistances();
-    }, LV_EVENT_CLICKED, NULL);
+  // Add trends button
+  lv_obj_t *trends_button = lv_btn_create(scr_more);
+  lv_obj_set_size(trends_button, 120, 40);
+  lv_obj_add_event_cb(trends_button, [](lv_event_t *e) -> void {
+    nav_push(ScreenID::SCREEN_MORE);
+    go_trends();
+  }, LV_EVENT_CLICKED, NULL);
 
-    lv_obj_t *wire_res_button_label = lv_label_create(wire_res_button);
-    lv_label_set_text(wire_res_button_label, "Wire Res.");
-    lv_obj_center(wire_res_button_label);
+  lv_obj_t *trends_button_label = lv_label_create(trends_button);
+  lv_label_set_text(trends_button_label, "Trends");
+  lv_obj_center(trends_button_label);
+
+  // Settings button
+  lv_obj_t *go_to_settings_btn = lv_btn_create(scr_more);
+  lv_obj_set_size(go_to_settings_btn, 120, 40);
+  lv_obj_align(go_to_settings_btn, LV_ALIGN_BOTTOM_MID, 0, 20);
+  lv_obj_add_event_cb(go_to_settings_btn, [](lv_event_t *e) -> void {
+    nav_push(ScreenID::SCREEN_MORE);
+    go_settings();
+  }, LV_EVENT_CLICKED, NULL);
 
-    // Settings button
-    lv_obj_t *go_to_settings_btn = lv_btn_create(scr_more);
-    lv_obj_set_size(go_to_settings_btn, 120, 40);
-    lv_obj_align(go_to_settings_btn, LV_ALIGN_BOTTOM_MID, 0, 20);
-    lv_obj_add_event_cb(go_to_settings_btn, [](lv_event_t *e) -> void {
-      nav_push(ScreenID::SCREEN_MORE);
-      go_settings();
-    }, LV_EVENT_CLICKED, NULL);
+  lv_obj_t *go_to_settings_btn_label = lv_label_create(go_to_settings_btn);
+  lv_label_set_text(go_to_settings_btn_label, LV_SYMBOL_SETTINGS);
+  lv_obj_align_to(go_to_settings_btn_label, go_to_settings_btn, LV_ALIGN_CENTER, 0, 0);
+}
 
-    lv_obj_t *go_to_settings_btn_label = lv_label_create(go_to_settings_btn);
-    lv_label_set_text(go_to_settings_btn_label, LV_SYMBOL_SETTINGS);
-    lv_obj_align_to(go_to_settings_btn_label, go_to_settings_btn, LV_ALIGN_CENTER, 0, 0);
-  }
+void go_more() {
+  if (!scr_more) build_more();
 
   lv_label_set_text(lbl_header, "");
   lv_obj_clear_flag(btn_back, LV_OBJ_FLAG_HIDDEN);
   lv_obj_clear_flag(btn_exit, LV_OBJ_FLAG_HIDDEN);
-  lv_screen_load(scr_more);
+  screen_cache_show(SCREEN_MORE);
 }
 
 // Home screen
 void go_main() {
   if (!scr_main) {
+    screen_cache_building(SCREEN_MAIN);
     scr_main = new_screen(NULL);
     lv_obj_set_size(scr_main, lv_disp_get_hor_res(NULL), lv_disp_get_ver_res(NULL));
 
@@ -610,41 +719,17 @@ void go_main() {
     lv_label_set_text(go_to_settings_btn_label, "More");
     lv_obj_align_to(go_to_settings_btn_label, go_to_more_btn, LV_ALIGN_CENTER, 0, 0);
 
-    soc_gauge = lv_arc_create(scr_main);
-    lv_arc_set_range(soc_gauge, 0, 100);
-    lv_obj_set_size(soc_gauge, 150, 150);
-    lv_arc_set_rotation(soc_gauge, 135);
-    lv_arc_set_bg_angles(soc_gauge, 0, 270);
-
-    // Make arc read-only
-    lv_obj_clear_flag(soc_gauge, LV_OBJ_FLAG_CLICKABLE);
-    lv_obj_set_style_bg_opa(soc_gauge, LV_OPA_TRANSP, LV_PART_KNOB);
-    lv_obj_set_style_pad_all(soc_gauge, 0, LV_PART_KNOB);
-
-    lv_obj_align(soc_gauge, LV_ALIGN_CENTER, 0, 0);
-
-    // Create label for percentage text
-    soc_gauge_label = lv_label_create(soc_gauge);
-    lv_obj_set_style_text_font(soc_gauge_label, &lv_font_montserrat_28, LV_PART_MAIN);
-    lv_obj_set_style_text_color(soc_gauge_label, lv_color_black(), LV_PART_MAIN);
-    lv_label_set_text(soc_gauge_label, "0%");
-    lv_obj_center(soc_gauge_label);
-
-    // Display battery voltage and current
-    battery_voltage_and_current_label = lv_label_create(scr_main);
-    lv_obj_set_style_text_font(battery_voltage_and_current_label, &lv_font_montserrat_18, LV_PART_MAIN);
-    lv_obj_set_style_text_color(battery_voltage_and_current_label, lv_color_black(), LV_PART_MAIN);
-    lv_label_set_text(battery_voltage_and_current_label, "V: --.--");
-    lv_obj_set_flex_align(battery_voltage_and_current_label, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_END, LV_FLEX_ALIGN_START);
-
-    // Initialize display with current BMS data
-    update_bms_display();
+    // One swipeable tile per saved BMS, built on first view
+    dashboard_create(scr_main);
   }
 
   lv_label_set_text(lbl_header, "");
   lv_obj_add_flag(btn_exit, LV_OBJ_FLAG_HIDDEN);
   lv_obj_add_flag(btn_back, LV_OBJ_FLAG_HIDDEN);
-  lv_screen_load(scr_main);
+  screen_cache_show(SCREEN_MAIN);
+
+  // Initialize display with current BMS data
+  update_bms_display();
 }
 
 // Handle back navigation based on previous screen
@@ -683,6 +768,14 @@ void handle_back_navigation() {
       go_wire_resistances();
       DEBUG_PRINTLN("going to scr_cell_resistances");
       break;
+    case SCREEN_TRENDS:
+      go_trends();
+      DEBUG_PRINTLN("going to scr_trends");
+      break;
+    case SCREEN_DIAGNOSTICS:
+      go_diagnostics();
+      DEBUG_PRINTLN("going to scr_diagnostics");
+      break;
     default:
       go_main();
       DEBUG_PRINTF("%d not found! Defaulting to scr_main...", prev);
@@ -710,8 +803,7 @@ void create_exit_btn() {
   btn_exit = lv_obj_create(lv_layer_top());
   lv_obj_clear_flag(btn_exit, LV_OBJ_FLAG_SCROLLABLE);
   lv_obj_add_flag(btn_exit, LV_OBJ_FLAG_CLICKABLE);
-  lv_obj_set_style_bg_opa(btn_exit, LV_OPA_TRANSP, LV_PART_MAIN);
-  lv_obj_set_style_border_width(btn_exit, 0, LV_PART_MAIN);
+  lv_obj_add_style(btn_exit, &style_transparent, LV_PART_MAIN);
   lv_obj_set_size(btn_exit, 40, 40);
   lv_obj_align(btn_exit, LV_ALIGN_TOP_RIGHT, 0, 0);
   lv_obj_add_event_cb(btn_exit, [](lv_event_t *e) -> void {
@@ -720,7 +812,7 @@ void create_exit_btn() {
 
   // Exit button symbol
   lv_obj_t *lbl_exit_symbol = lv_label_create(btn_exit);
-  lv_obj_set_style_text_font(lbl_exit_symbol, &lv_font_montserrat_18, LV_PART_MAIN);
+  lv_obj_add_style(lbl_exit_symbol, &style_text_title, LV_PART_MAIN);
   lv_obj_set_style_text_align(lbl_exit_symbol, LV_TEXT_ALIGN_RIGHT, 0);
   lv_label_set_text(lbl_exit_symbol, LV_SYMBOL_CLOSE);
   lv_obj_align(lbl_exit_symbol, LV_ALIGN_TOP_RIGHT, 5, -10);
@@ -731,14 +823,13 @@ void create_back_btn() {
   btn_back = lv_obj_create(lv_layer_top());
   lv_obj_clear_flag(btn_back, LV_OBJ_FLAG_SCROLLABLE);
   lv_obj_add_flag(btn_back, LV_OBJ_FLAG_CLICKABLE);
-  lv_obj_set_style_bg_opa(btn_back, LV_OPA_TRANSP, LV_PART_MAIN);
-  lv_obj_set_style_border_width(btn_back, 0, LV_PART_MAIN);
+  lv_obj_add_style(btn_back, &style_transparent, LV_PART_MAIN);
   lv_obj_set_size(btn_back, 40, 40);
   lv_obj_align(btn_back, LV_ALIGN_TOP_LEFT, 0, 0);
 
   // Back button symbol
   lv_obj_t *lbl_back_symbol = lv_label_create(btn_back);
-  lv_obj_set_style_text_font(lbl_back_symbol, &lv_font_montserrat_18, LV_PART_MAIN);
+  lv_obj_add_style(lbl_back_symbol, &style_text_title, LV_PART_MAIN);
   lv_obj_set_style_text_align(lbl_back_symbol, LV_TEXT_ALIGN_CENTER, 0);
   lv_label_set_text(lbl_back_symbol, LV_SYMBOL_BACKSPACE);
   lv_obj_align(lbl_back_symbol, LV_ALIGN_TOP_MID, 5, -10);
@@ -746,8 +837,9 @@ void create_back_btn() {
 
 void ui_init() {
   DEBUG_PRINTLN("Initializing UI...");
-  // Initialize LVGL and display
-  LVGL_CYD::begin(SCREEN_ORIENTATION);
+  // Initialize LVGL, display and touch
+  display_init(SCREEN_ORIENTATION);
+  theme_init();
 
   setup_lv_layers();
 
@@ -760,9 +852,47 @@ void ui_init() {
 
   // Page header
   lbl_header = lv_label_create(lv_layer_top());
-  lv_obj_set_style_text_font(lbl_header, &lv_font_montserrat_18, LV_PART_MAIN);
+  lv_obj_add_style(lbl_header, &style_text_title, LV_PART_MAIN);
   lv_obj_align(lbl_header, LV_ALIGN_TOP_MID, 5, 3);
 
+  // Shown over every screen while the connected BMS has stopped sending frames
+  lbl_stale = lv_label_create(lv_layer_top());
+  lv_obj_add_style(lbl_stale, &style_text_warning, LV_PART_MAIN);
+  lv_label_set_text(lbl_stale, LV_SYMBOL_WARNING " No new data");
+  lv_obj_align(lbl_stale, LV_ALIGN_BOTTOM_RIGHT, -5, -5);
+  lv_obj_add_flag(lbl_stale, LV_OBJ_FLAG_HIDDEN);
+
+  // Screens other than main may be deleted under memory pressure and rebuilt on the next visit
+  screen_cache_register(SCREEN_MAIN, &scr_main, nullptr, true);
+  screen_cache_register(SCREEN_MORE, &scr_more, nullptr);
+  screen_cache_register(SCREEN_SETTINGS, &scr_settings, nullptr);
+  screen_cache_register(SCREEN_DISPLAY_SETTINGS, &scr_display_settings, nullptr);
+  screen_cache_register(SCREEN_BL, &scr_backlight, []() { slider_bl = nullptr; });
+  screen_cache_register(SCREEN_CONNECT_JK_DEVICE, &scr_connect_jk_device, []() { jk_devices_scroll_container = nullptr; });
+  screen_cache_register(SCREEN_CELL_VOLTAGES, &scr_cell_voltages, []() {
+    delta_voltages_table = nullptr;
+    cell_voltage_bars = nullptr;
+  });
+  screen_cache_register(SCREEN_CELL_RESISTANCES, &scr_cell_resistances, []() {
+    res_high_low_avg_table = nullptr;
+    wire_res_bars = nullptr;
+  });
+  screen_cache_register(SCREEN_TRENDS, &scr_trends, trends_on_evict);
+  screen_cache_register(SCREEN_DIAGNOSTICS, &scr_diagnostics, diagnostics_on_evict);
+
+  // Built in the background, in the order they are usually opened from the home screen
+  prebuild_add(SCREEN_MORE, &scr_more, build_more);
+  prebuild_add(SCREEN_CELL_VOLTAGES, &scr_cell_voltages, build_cell_voltages);
+  prebuild_add(SCREEN_CELL_RESISTANCES, &scr_cell_resistances, build_wire_resistances);
+  prebuild_add(SCREEN_TRENDS, &scr_trends, build_trends);
+  prebuild_add(SCREEN_SETTINGS, &scr_settings, build_settings);
+
   // Launch main screen on startup
   go_main();
+
+  if (UI_BENCHMARK_ON_BOOT) {
+    cell_bars_benchmark(20);
+    fonts_benchmark(20);
+  }
+  if (DISPLAY_BENCHMARK_ON_BOOT) display_benchmark(30);
 }
\ No newline at end of file
@@ -6,13 +6,10 @@
 class JKBMS;
 
 // Global LVGL elements
-extern lv_obj_t *soc_gauge;
-extern lv_obj_t *soc_gauge_label;
 extern lv_obj_t *battery_current_label;
-extern lv_obj_t *battery_voltage_and_current_label;
-extern lv_obj_t *cell_voltage_table;
+extern lv_obj_t *cell_voltage_bars;
 extern lv_obj_t *delta_voltages_table;
-extern lv_obj_t *wire_res_table;
+extern lv_obj_t *wire_res_bars;
 extern lv_obj_t *res_high_low_avg_table;
 
 // Screen objects
@@ -27,14 +24,11 @@ extern lv_obj_t *scr_backlight;
 extern lv_obj_t *btn_back;
 extern lv_obj_t *btn_exit;
 extern lv_obj_t *lbl_header;
+extern lv_obj_t *lbl_stale;
 extern lv_obj_t *slider_bl;
 extern lv_obj_t *horizontal;
 extern lv_obj_t *vertical;
 
-// Global variables for LVGL components
-extern float battery_voltage;
-extern float battery_current;
-
 // Screen creation and navigation functions
 lv_obj_t *new_screen(lv_obj_t *parent);
 void ui_navigation_init();
@@ -49,10 +43,17 @@ void go_cell_voltages();
 void go_wire_resistances();
 
 // element creation functions
-lv_obj_t *create_device_list_button(const char *name, const char *mac_address);
+lv_obj_t *create_device_list_button(const char *name, const char *mac_address, int rssi);
+bool update_device_list_button(const char *name, const char *mac_address, int rssi);
+void show_alert(const char *title, const char *text);
 
 // Update functions
-void update_bms_display();
+// Returns true if any widget changed; rxUs receives the receive time of a sample
+// shown for the first time, 0 when only an already measured one was redrawn
+bool update_bms_display(uint32_t *rxUs = nullptr);
+// Samples resume after the screen was blanked. The one kept from before is
+// not flagged stale until DISPLAY_STALE_TIMEOUT passes without a new one.
+void update_bms_display_resumed();
 
 // init
 void ui_init();
@@ -0,0 +1,88 @@
+#include "theme.h"
+#include "fonts.h"
+
+lv_style_t style_transparent;
+lv_style_t style_screen;
+lv_style_t style_container;
+lv_style_t style_pad_row_tight;
+lv_style_t style_table_items;
+lv_style_t style_table_compact;
+lv_style_t style_text_small;
+lv_style_t style_text_title;
+lv_style_t style_text_value;
+lv_style_t style_text_large;
+lv_style_t style_text_warning;
+lv_style_t style_device_row;
+lv_style_t style_knob_hidden;
+lv_style_t style_overlay;
+lv_style_t style_alarm;
+
+void theme_init() {
+  static bool initialized = false;
+  if (initialized) return;
+  initialized = true;
+
+  lv_style_init(&style_transparent);
+  lv_style_set_bg_opa(&style_transparent, LV_OPA_TRANSP);
+  lv_style_set_border_width(&style_transparent, 0);
+
+  lv_style_init(&style_screen);
+  lv_style_set_pad_top(&style_screen, 20);
+  lv_style_set_pad_row(&style_screen, 10);
+
+  lv_style_init(&style_container);
+  lv_style_set_pad_all(&style_container, 10);
+
+  lv_style_init(&style_pad_row_tight);
+  lv_style_set_pad_row(&style_pad_row_tight, 4);
+
+  lv_style_init(&style_table_items);
+  lv_style_set_bg_color(&style_table_items, lv_color_hex(0xE0E0E0));
+  lv_style_set_text_font(&style_table_items, FONT_BODY);
+
+  lv_style_init(&style_table_compact);
+  lv_style_set_text_font(&style_table_compact, FONT_SMALL);
+  lv_style_set_pad_ver(&style_table_compact, 2);
+
+  lv_style_init(&style_text_small);
+  lv_style_set_text_font(&style_text_small, FONT_BODY);
+
+  lv_style_init(&style_text_title);
+  lv_style_set_text_font(&style_text_title, FONT_TITLE);
+
+  lv_style_init(&style_text_value);
+  lv_style_set_text_font(&style_text_value, FONT_TITLE);
+  lv_style_set_text_color(&style_text_value, lv_color_black());
+
+  lv_style_init(&style_text_large);
+  lv_style_set_text_font(&style_text_large, FONT_SOC);
+  lv_style_set_text_color(&style_text_large, lv_color_black());
+
+  lv_style_init(&style_text_warning);
+  lv_style_set_text_font(&style_text_warning, FONT_BODY);
+  lv_style_set_text_color(&style_text_warning, lv_palette_main(LV_PALETTE_ORANGE));
+
+  lv_style_init(&style_device_row);
+  lv_style_set_pad_all(&style_device_row, 4);
+  lv_style_set_pad_column(&style_device_row, 10);
+
+  lv_style_init(&style_knob_hidden);
+  lv_style_set_bg_opa(&style_knob_hidden, LV_OPA_TRANSP);
+  lv_style_set_pad_all(&style_knob_hidden, 0);
+
+  lv_style_init(&style_overlay);
+  lv_style_set_text_font(&style_overlay, FONT_OVERLAY);
+  lv_style_set_text_color(&style_overlay, lv_color_white());
+  lv_style_set_bg_color(&style_overlay, lv_color_black());
+  lv_style_set_bg_opa(&style_overlay, LV_OPA_70);
+
+  // Body font: alarm names aren't UI literals, so they aren't in the subset fonts
+  lv_style_init(&style_alarm);
+  lv_style_set_text_font(&style_alarm, FONT_BODY);
+  lv_style_set_text_color(&style_alarm, lv_color_white());
+  lv_style_set_bg_color(&style_alarm, lv_palette_main(LV_PALETTE_RED));
+  lv_style_set_bg_opa(&style_alarm, LV_OPA_COVER);
+  lv_style_set_border_width(&style_alarm, 0);
+  lv_style_set_radius(&style_alarm, 0);
+  lv_style_set_pad_all(&style_alarm, 6);
+}
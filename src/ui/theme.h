@@ -0,0 +1,28 @@
+#pragma once
+
+#include <lvgl.h>
+
+// Shared styles
+// Initialized once by theme_init() and added to widgets with
+// lv_obj_add_style(). A shared style costs one pointer per widget instead
+// of a local style list each, and LVGL resolves the same style object for
+// every widget that uses it. Properties that change at runtime (e.g.
+// connection colors) stay local.
+
+void theme_init();
+
+extern lv_style_t style_transparent;    // No background or border: screens, containers, icon buttons
+extern lv_style_t style_screen;         // Flex column screens from new_screen()
+extern lv_style_t style_container;      // Padding of scrollable content containers
+extern lv_style_t style_pad_row_tight;  // Dense columns: dashboard tiles, trends
+extern lv_style_t style_table_items;    // LV_PART_ITEMS of data tables
+extern lv_style_t style_table_compact;  // LV_PART_ITEMS of small-print tables
+extern lv_style_t style_text_small;     // 14 px
+extern lv_style_t style_text_title;     // 18 px: header, navigation symbols
+extern lv_style_t style_text_value;     // 18 px, black: dashboard voltage/current
+extern lv_style_t style_text_large;     // 28 px, black: SOC
+extern lv_style_t style_text_warning;   // 14 px, orange
+extern lv_style_t style_device_row;     // Scan result buttons
+extern lv_style_t style_knob_hidden;    // LV_PART_KNOB of read-only arcs
+extern lv_style_t style_overlay;        // Diagnostics overlay label
+extern lv_style_t style_alarm;          // Alarm banner
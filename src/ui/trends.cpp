@@ -0,0 +1,239 @@
+#include "trends.h"
+#include <new>
+#include "screens.h"
+#include "dashboard.h"
+#include "screen_cache.h"
+#include "theme.h"
+#include "ui_queue.h"
+#include "../config/config.h"
+#include "../utils/utils.h"
+#include "../utils/trend_buffer.h"
+#include "../bms/telemetry.h"
+
+enum TrendMetric {
+  TREND_VOLTAGE,   // 10 mV units
+  TREND_CURRENT,   // 100 mA units
+  TREND_POWER,     // W
+  TREND_METRICS
+};
+
+struct DeviceTrends {
+  TrendSeries series[TREND_METRICS];
+};
+
+static DeviceTrends *trends[BMS_MAX_DEVICES] = { nullptr };
+
+lv_obj_t *scr_trends = nullptr;
+static lv_obj_t *chart = nullptr;
+static lv_obj_t *range_label = nullptr;
+static lv_chart_series_t *ser_max = nullptr;
+static lv_chart_series_t *ser_min = nullptr;
+
+// What the chart currently shows
+static int viewSlot = -1;
+static int viewMetric = TREND_VOLTAGE;
+static int viewLevel = 0;
+static uint32_t viewPushed = 0;
+static int32_t axisLo = 0, axisHi = 0;
+
+static const char *metric_units[TREND_METRICS] = { "V", "A", "W" };
+static const int32_t metric_scale[TREND_METRICS] = { 100, 10, 1 };  // Stored units per displayed unit
+
+static int16_t clamp16(int32_t v) {
+  if (v > INT16_MAX) return INT16_MAX;
+  if (v <= INT16_MIN) return INT16_MIN + 1;
+  return v;
+}
+
+// Axis range with some headroom, snapped to whole display units so it rarely changes
+static bool fit_axis(int32_t lo, int32_t hi) {
+  int32_t step = metric_scale[viewMetric];
+  int32_t newLo = (lo / step - (lo < 0 ? 2 : 1)) * step;
+  int32_t newHi = (hi / step + (hi < 0 ? 1 : 2)) * step;
+  if (newLo == axisLo && newHi == axisHi) return false;
+  axisLo = newLo;
+  axisHi = newHi;
+  lv_chart_set_axis_range(chart, LV_CHART_AXIS_PRIMARY_Y, axisLo, axisHi);
+  return true;
+}
+
+static void update_range_label() {
+  int32_t step = metric_scale[viewMetric];
+  lv_label_set_text_fmt(range_label, "%ld .. %ld %s", (long)(axisLo / step), (long)(axisHi / step), metric_units[viewMetric]);
+}
+
+// Full redraw, only when device, metric or time range changes
+static void reload_chart() {
+  if (!chart) return;
+  lv_chart_set_all_value(chart, ser_max, LV_CHART_POINT_NONE);
+  lv_chart_set_all_value(chart, ser_min, LV_CHART_POINT_NONE);
+  lv_chart_set_x_start_point(chart, ser_max, 0);
+  lv_chart_set_x_start_point(chart, ser_min, 0);
+  viewPushed = 0;
+
+  DeviceTrends *t = viewSlot >= 0 ? trends[viewSlot] : nullptr;
+  if (!t) {
+    lv_label_set_text(range_label, "No data yet");
+    lv_chart_refresh(chart);
+    return;
+  }
+
+  const TrendLevel &level = t->series[viewMetric].level(viewLevel);
+  int32_t lo = INT32_MAX, hi = INT32_MIN;
+  for (int i = 0; i < level.size(); i++) {
+    TrendPoint p = level.at(i);
+    lv_chart_set_next_value(chart, ser_max, p.max == TREND_NONE ? LV_CHART_POINT_NONE : p.max);
+    lv_chart_set_next_value(chart, ser_min, p.min == TREND_NONE ? LV_CHART_POINT_NONE : p.min);
+    if (p.min != TREND_NONE && p.min < lo) lo = p.min;
+    if (p.max != TREND_NONE && p.max > hi) hi = p.max;
+  }
+  viewPushed = level.pushed();
+  if (lo <= hi) fit_axis(lo, hi);
+  update_range_label();
+  lv_chart_refresh(chart);
+}
+
+// Appends points completed since the last call; only their columns are redrawn
+static bool append_new_points() {
+  DeviceTrends *t = viewSlot >= 0 ? trends[viewSlot] : nullptr;
+  if (!t) return false;
+  const TrendLevel &level = t->series[viewMetric].level(viewLevel);
+  uint32_t fresh = level.pushed() - viewPushed;
+  if (fresh == 0) return false;
+  if (fresh > (uint32_t)level.size()) {
+    reload_chart();
+    return true;
+  }
+
+  for (int i = level.size() - fresh; i < level.size(); i++) {
+    TrendPoint p = level.at(i);
+    if (p.max != TREND_NONE && (p.max > axisHi || p.min < axisLo)) {
+      // Out of range, rescale on the full visible data instead
+      reload_chart();
+      return true;
+    }
+    lv_chart_set_next_value(chart, ser_max, p.max == TREND_NONE ? LV_CHART_POINT_NONE : p.max);
+    lv_chart_set_next_value(chart, ser_min, p.min == TREND_NONE ? LV_CHART_POINT_NONE : p.min);
+  }
+  viewPushed = level.pushed();
+  return true;
+}
+
+bool trends_drain() {
+  TelemetrySample s;
+  for (int slot = 0; slot < BMS_MAX_DEVICES; slot++) {
+    // Release history of forgotten devices
+    if (!ui_pack(slot)) {
+      telemetry_flush(TELEMETRY_HISTORY, slot);
+      if (trends[slot]) {
+        delete trends[slot];
+        trends[slot] = nullptr;
+      }
+      continue;
+    }
+
+    while (telemetry_pop(TELEMETRY_HISTORY, slot, s)) {
+      if (!trends[slot]) {
+        trends[slot] = new (std::nothrow) DeviceTrends();
+        if (!trends[slot]) {
+          DEBUG_PRINTLN("No memory for trend history");
+          break;
+        }
+      }
+      DeviceTrends *t = trends[slot];
+      t->series[TREND_VOLTAGE].add(s.timeMs, clamp16(s.packMv / 10));
+      t->series[TREND_CURRENT].add(s.timeMs, clamp16(s.currentMa / 100));
+      t->series[TREND_POWER].add(s.timeMs, clamp16((int32_t)((int64_t)s.packMv * s.currentMa / 1000000)));
+    }
+  }
+
+  if (!scr_trends || lv_screen_active() != scr_trends) return false;
+  return append_new_points();
+}
+
+static void select_view(int slot, int metric, int level) {
+  if (slot == viewSlot && metric == viewMetric && level == viewLevel) return;
+  viewSlot = slot;
+  viewMetric = metric;
+  viewLevel = level;
+  axisLo = axisHi = 0;
+  reload_chart();
+}
+
+void trends_on_evict() {
+  chart = nullptr;
+  range_label = nullptr;
+  ser_max = ser_min = nullptr;
+}
+
+static int trends_slot() {
+  int slot = dashboard_selected_slot();
+  if (slot >= 0) return slot;
+  for (int i = 0; i < BMS_MAX_DEVICES; i++) {
+    if (trends[i]) return i;
+  }
+  return -1;
+}
+
+// Builds without showing, also used by the prebuilder
+void build_trends() {
+  screen_cache_building(SCREEN_TRENDS);
+  scr_trends = new_screen(NULL);
+  lv_obj_set_size(scr_trends, lv_disp_get_hor_res(NULL), lv_disp_get_ver_res(NULL));
+  lv_obj_add_style(scr_trends, &style_pad_row_tight, LV_PART_MAIN);
+  lv_obj_set_flex_flow(scr_trends, LV_FLEX_FLOW_ROW_WRAP);
+
+  static const char *metric_map[] = { "V", "A", "W", "" };
+  lv_obj_t *metric_btns = lv_buttonmatrix_create(scr_trends);
+  lv_buttonmatrix_set_map(metric_btns, metric_map);
+  lv_buttonmatrix_set_button_ctrl_all(metric_btns, LV_BUTTONMATRIX_CTRL_CHECKABLE);
+  lv_buttonmatrix_set_one_checked(metric_btns, true);
+  lv_buttonmatrix_set_button_ctrl(metric_btns, viewMetric, LV_BUTTONMATRIX_CTRL_CHECKED);  // Kept across evictions
+  lv_obj_set_size(metric_btns, lv_pct(45), 36);
+  lv_obj_add_event_cb(metric_btns, [](lv_event_t *e) -> void {
+    lv_obj_t *btns = lv_event_get_target_obj(e);
+    select_view(viewSlot, lv_buttonmatrix_get_selected_button(btns), viewLevel);
+  }, LV_EVENT_VALUE_CHANGED, NULL);
+
+  static const char *range_map[] = { "2m", "20m", "2h", "" };
+  lv_obj_t *range_btns = lv_buttonmatrix_create(scr_trends);
+  lv_buttonmatrix_set_map(range_btns, range_map);
+  lv_buttonmatrix_set_button_ctrl_all(range_btns, LV_BUTTONMATRIX_CTRL_CHECKABLE);
+  lv_buttonmatrix_set_one_checked(range_btns, true);
+  lv_buttonmatrix_set_button_ctrl(range_btns, viewLevel, LV_BUTTONMATRIX_CTRL_CHECKED);
+  lv_obj_set_size(range_btns, lv_pct(45), 36);
+  lv_obj_add_event_cb(range_btns, [](lv_event_t *e) -> void {
+    lv_obj_t *btns = lv_event_get_target_obj(e);
+    select_view(viewSlot, viewMetric, lv_buttonmatrix_get_selected_button(btns));
+  }, LV_EVENT_VALUE_CHANGED, NULL);
+
+  chart = lv_chart_create(scr_trends);
+  lv_obj_set_size(chart, lv_pct(95), lv_pct(60));
+  lv_chart_set_type(chart, LV_CHART_TYPE_LINE);
+  lv_chart_set_point_count(chart, TREND_POINTS);
+  lv_chart_set_update_mode(chart, LV_CHART_UPDATE_MODE_CIRCULAR);
+  lv_chart_set_div_line_count(chart, 4, 6);
+  lv_obj_set_style_size(chart, 0, 0, LV_PART_INDICATOR);  // No point markers
+  lv_obj_set_style_line_width(chart, 2, LV_PART_ITEMS);
+  ser_max = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_RED), LV_CHART_AXIS_PRIMARY_Y);
+  ser_min = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_BLUE), LV_CHART_AXIS_PRIMARY_Y);
+
+  range_label = lv_label_create(scr_trends);
+  lv_obj_add_style(range_label, &style_text_small, LV_PART_MAIN);
+
+  viewSlot = -2;  // Force the first reload
+}
+
+void go_trends() {
+  if (!scr_trends) build_trends();
+
+  lv_label_set_text(lbl_header, "Trends");
+  lv_obj_clear_flag(btn_back, LV_OBJ_FLAG_HIDDEN);
+  lv_obj_clear_flag(btn_exit, LV_OBJ_FLAG_HIDDEN);
+  screen_cache_show(SCREEN_TRENDS);
+
+  // Catch up on points that arrived while the screen was hidden
+  int slot = trends_slot();
+  if (slot != viewSlot) select_view(slot, viewMetric, viewLevel);
+  else append_new_points();
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <lvgl.h>
+
+// Trend charts
+// Drains the TELEMETRY_HISTORY consumer into per-device decimating
+// buffers (utils/trend_buffer) and shows voltage, current or power as a
+// min/max envelope over 2 min, 20 min or 2 h. The chart runs in circular
+// mode, so a new point only invalidates its own column.
+
+// UI task only. Returns true if the visible chart changed.
+bool trends_drain();
+
+void go_trends();
+// Builds the screen without showing it, for the prebuilder
+void build_trends();
+
+// Clears widget pointers when the screen cache deletes the trends screen
+void trends_on_evict();
+
+extern lv_obj_t *scr_trends;
@@ -0,0 +1,148 @@
+#include "ui_queue.h"
+#include "screens.h"
+#include "dashboard.h"
+#include "idle.h"
+#include "alarm_banner.h"
+#include "../config/config.h"
+#include "../utils/utils.h"
+#include "../tasks/tasks.h"
+#include "../bms/jkbms.h"
+
+static QueueHandle_t uiQueue = nullptr;
+static UiPackInfo packs[BMS_MAX_DEVICES];
+static TelemetrySample latestSample[BMS_MAX_DEVICES];
+static bool haveSample[BMS_MAX_DEVICES] = { false };
+
+uint32_t uiQueueOverflows = 0;
+
+void ui_queue_init() {
+  uiQueue = xQueueCreate(UI_QUEUE_LEN, sizeof(UiCmd));
+}
+
+bool ui_post(const UiCmd &cmd) {
+  bool queued = xQueueSend(uiQueue, &cmd, 0) == pdTRUE;
+  if (!queued) uiQueueOverflows++;
+  // Wake the UI task even if the queue was full, it still has work to drain
+  ui_wake();
+  return queued;
+}
+
+bool ui_post_event(UiCmdType type, int slot) {
+  UiCmd cmd;
+  cmd.type = type;
+  cmd.slot = slot;
+  return ui_post(cmd);
+}
+
+bool ui_post_device_row(UiCmdType type, const char *name, const char *mac, int rssi) {
+  UiCmd cmd;
+  cmd.type = type;
+  cmd.slot = -1;
+  strlcpy(cmd.device.name, name ? name : "", sizeof(cmd.device.name));
+  strlcpy(cmd.device.mac, mac ? mac : "", sizeof(cmd.device.mac));
+  cmd.device.rssi = rssi;
+  return ui_post(cmd);
+}
+
+bool ui_post_alert(const char *title, const char *text) {
+  UiCmd cmd;
+  cmd.type = UI_CMD_SHOW_ALERT;
+  cmd.slot = -1;
+  strlcpy(cmd.alert.title, title ? title : "", sizeof(cmd.alert.title));
+  strlcpy(cmd.alert.text, text ? text : "", sizeof(cmd.alert.text));
+  return ui_post(cmd);
+}
+
+bool ui_post_pack(UiCmdType type, int slot, const JKBMS *bms) {
+  UiCmd cmd;
+  cmd.type = type;
+  cmd.slot = slot;
+  cmd.pack = {};
+  if (bms) {
+    strlcpy(cmd.pack.mac, bms->targetMAC, sizeof(cmd.pack.mac));
+    cmd.pack.connected = bms->connected;
+    cmd.pack.frames = bms->framesReceived;
+    cmd.pack.lastParseUs = bms->lastParseUs;
+    cmd.pack.maxParseUs = bms->maxParseUs;
+  }
+  return ui_post(cmd);
+}
+
+static bool valid_slot(int slot) {
+  return slot >= 0 && slot < BMS_MAX_DEVICES;
+}
+
+uint8_t ui_queue_drain() {
+  uint8_t dirty = 0;
+  UiCmd cmd;
+
+  // Bounded so a flood of scan results can't starve rendering;
+  // whatever is left is picked up on the next pass
+  for (int n = 0; n < UI_QUEUE_BATCH && xQueueReceive(uiQueue, &cmd, 0) == pdTRUE; n++) {
+    switch (cmd.type) {
+      case UI_CMD_DATA_READY:
+        // Any number of frames in one batch becomes a single redraw
+        if (valid_slot(cmd.slot)) packs[cmd.slot] = cmd.pack;
+        dirty |= UI_DIRTY_DATA;
+        break;
+      case UI_CMD_CONNECTION_CHANGED:
+        if (valid_slot(cmd.slot)) packs[cmd.slot] = cmd.pack;
+        dirty |= UI_DIRTY_CONNECTION;
+        break;
+      case UI_CMD_DEVICES_CHANGED:
+        if (!valid_slot(cmd.slot)) break;
+        packs[cmd.slot] = cmd.pack;
+        // Samples still queued belong to the slot's previous pack
+        telemetry_flush(TELEMETRY_UI, cmd.slot);
+        haveSample[cmd.slot] = false;
+        dashboard_sync();
+        alarm_banner_update();
+        dirty |= UI_DIRTY_CONNECTION;
+        break;
+      case UI_CMD_ALARMS_CHANGED:
+        alarm_banner_update();
+        break;
+      case UI_CMD_ADD_DEVICE_ROW:
+      case UI_CMD_UPDATE_DEVICE_ROW:
+        // Active scans report the same device repeatedly, update its row in place
+        if (!update_device_list_button(cmd.device.name, cmd.device.mac, cmd.device.rssi) && cmd.type == UI_CMD_ADD_DEVICE_ROW) {
+          create_device_list_button(cmd.device.name, cmd.device.mac, cmd.device.rssi);
+        }
+        break;
+      case UI_CMD_SHOW_ALERT:
+        idle_wake();
+        show_alert(cmd.alert.title, cmd.alert.text);
+        break;
+    }
+  }
+
+  return dirty;
+}
+
+uint8_t ui_telemetry_drain() {
+  uint8_t dirty = 0;
+  for (int slot = 0; slot < BMS_MAX_DEVICES; slot++) {
+    // A freed slot may be reused by another pack, don't show the old one's data
+    if (!ui_pack(slot)) {
+      telemetry_flush(TELEMETRY_UI, slot);
+      haveSample[slot] = false;
+      continue;
+    }
+    // The screen only shows the newest reading, older ones are just consumed
+    while (telemetry_pop(TELEMETRY_UI, slot, latestSample[slot])) {
+      haveSample[slot] = true;
+      dirty |= UI_DIRTY_DATA;
+    }
+  }
+  return dirty;
+}
+
+const TelemetrySample *ui_sample(int slot) {
+  if (!valid_slot(slot) || !haveSample[slot]) return nullptr;
+  return &latestSample[slot];
+}
+
+const UiPackInfo *ui_pack(int slot) {
+  if (!valid_slot(slot) || !packs[slot].mac[0]) return nullptr;
+  return &packs[slot];
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Arduino.h>
+#include "../bms/telemetry.h"
+
+// Deferred UI work
+// LVGL is not thread-safe, so code running outside the UI task (NimBLE
+// callbacks, the BMS task) never touches widgets. It posts a typed command
+// here instead and the UI task applies the queued commands in batches
+// before each lv_timer_handler pass.
+// The JKBMS objects belong to the BMS task. Pack events carry a copy of
+// the pack's state, which is all the UI ever reads about a pack.
+
+class JKBMS;
+
+enum UiCmdType {
+  UI_CMD_DATA_READY,          // A frame was decoded for the device in slot, with pack state
+  UI_CMD_CONNECTION_CHANGED,  // The device in slot connected or disconnected, with pack state
+  UI_CMD_DEVICES_CHANGED,     // A device was added to or removed from slot, with pack state
+  UI_CMD_ADD_DEVICE_ROW,      // A device was found by a scan
+  UI_CMD_UPDATE_DEVICE_ROW,   // A listed device was seen again (name/RSSI changed)
+  UI_CMD_ALARMS_CHANGED,      // An alarm of the device in slot was raised or cleared
+  UI_CMD_SHOW_ALERT
+};
+
+// The UI task's copy of a pack, taken by the task that owns the JKBMS
+struct UiPackInfo {
+  char mac[18];               // Empty while the slot is free
+  bool connected;
+  uint32_t frames;            // Complete frames that passed the checksum
+  uint32_t lastParseUs;
+  uint32_t maxParseUs;
+};
+
+struct UiCmd {
+  UiCmdType type;
+  int8_t slot;
+  union {
+    UiPackInfo pack;
+    struct {
+      char name[24];
+      char mac[18];
+      int8_t rssi;
+    } device;
+    struct {
+      char title[24];
+      char text[64];
+    } alert;
+  };
+};
+
+// What a drained batch changed, after coalescing
+#define UI_DIRTY_DATA        0x01
+#define UI_DIRTY_CONNECTION  0x02
+
+void ui_queue_init();
+
+// Safe to call from any task, never blocks. Returns false when the queue is full.
+bool ui_post(const UiCmd &cmd);
+bool ui_post_event(UiCmdType type, int slot);
+bool ui_post_device_row(UiCmdType type, const char *name, const char *mac, int rssi);
+bool ui_post_alert(const char *title, const char *text);
+// From the task that owns bms. nullptr reports the slot as free.
+bool ui_post_pack(UiCmdType type, int slot, const JKBMS *bms);
+
+// UI task only. Applies up to UI_QUEUE_BATCH commands and returns UI_DIRTY_* flags.
+uint8_t ui_queue_drain();
+
+// UI task only. Drains the TELEMETRY_UI rings into the latest sample per
+// slot and returns UI_DIRTY_DATA if anything new arrived.
+uint8_t ui_telemetry_drain();
+
+// Latest sample for the device in slot, nullptr before its first frame
+const TelemetrySample *ui_sample(int slot);
+
+// UI task only. State of the device in slot, nullptr if the slot is free
+const UiPackInfo *ui_pack(int slot);
+
+extern uint32_t uiQueueOverflows;
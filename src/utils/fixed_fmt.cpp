@@ -0,0 +1,35 @@
+#include "fixed_fmt.h"
+
+static const uint32_t pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+size_t fixed_format(char *out, size_t size, int32_t value, uint8_t scale, uint8_t decimals) {
+  if (size == 0) return 0;
+  if (scale > 9) scale = 9;
+  if (decimals > scale) decimals = scale;
+
+  // Work on the magnitude in 64 bits so INT32_MIN and rounding can't overflow
+  bool negative = value < 0;
+  uint64_t magnitude = negative ? (uint64_t)(-(int64_t)value) : (uint64_t)value;
+  uint32_t drop = pow10[scale - decimals];
+  magnitude = (magnitude + drop / 2) / drop;
+
+  // Digits right to left; at least one integer digit and all decimals
+  char digits[24];
+  int count = 0;
+  do {
+    if (count == decimals && decimals) digits[count++] = '.';
+    digits[count++] = '0' + magnitude % 10;
+    magnitude /= 10;
+  } while (magnitude || count <= decimals);
+  // printf keeps the sign of a value that rounds to zero, e.g. "-0.00"
+  if (negative) digits[count++] = '-';
+
+  size_t len = 0;
+  while (count > 0 && len + 1 < size) out[len++] = digits[--count];
+  out[len] = '\0';
+  return len;
+}
+
+size_t int_format(char *out, size_t size, int32_t value) {
+  return fixed_format(out, size, value, 0, 0);
+}
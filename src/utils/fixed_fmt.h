@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Fixed-point text formatting
+// Turns the integer units the BMS reports (mV, mA, mOhm, 0.1 C) into
+// decimal text without floating point or printf. Values are written into
+// caller-owned buffers, so a widget can keep one buffer and hand it to
+// lv_label_set_text_static() instead of having LVGL format and allocate.
+
+// Writes value / 10^scale with `decimals` digits after the point, rounded
+// like printf ("%.2f" of 53126 mV, scale 3 -> "53.13"), except that exact
+// ties round away from zero where printf rounds them to even.
+// decimals may be 0 (no point) up to scale. Returns the length written, not
+// counting the terminator; the text is cut short if `size` is too small.
+size_t fixed_format(char *out, size_t size, int32_t value, uint8_t scale, uint8_t decimals);
+
+// Plain integer, same contract as fixed_format
+size_t int_format(char *out, size_t size, int32_t value);
+
+// Builds a line of text in a fixed buffer, e.g. "V: 53.13   A: -12.500"
+template <size_t N>
+struct FixedText {
+  char buf[N];
+  size_t len = 0;
+
+  FixedText() { buf[0] = '\0'; }
+
+  FixedText &clear() {
+    len = 0;
+    buf[0] = '\0';
+    return *this;
+  }
+
+  FixedText &add(const char *text) {
+    while (*text && len + 1 < N) buf[len++] = *text++;
+    buf[len] = '\0';
+    return *this;
+  }
+
+  FixedText &add(int32_t value) {
+    len += int_format(buf + len, N - len, value);
+    return *this;
+  }
+
+  FixedText &add(int32_t value, uint8_t scale, uint8_t decimals) {
+    len += fixed_format(buf + len, N - len, value, scale, decimals);
+    return *this;
+  }
+
+  const char *c_str() const { return buf; }
+};
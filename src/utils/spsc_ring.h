@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// Fixed-capacity single-producer/single-consumer ring buffer.
+// push() is only called from the producer task and pop() only from the
+// consumer task; neither blocks or takes a lock. A full ring drops the new
+// item and counts it, so a slow consumer can never stall the producer.
+template <typename T, size_t N>
+class SpscRing {
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "Ring capacity must be a power of two");
+
+public:
+  bool push(const T &item) {
+    uint32_t head = headIdx.load(std::memory_order_relaxed);
+    if (head - tailIdx.load(std::memory_order_acquire) >= N) {
+      overflows.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    items[head & (N - 1)] = item;
+    headIdx.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T &item) {
+    uint32_t tail = tailIdx.load(std::memory_order_relaxed);
+    if (tail == headIdx.load(std::memory_order_acquire)) return false;
+    item = items[tail & (N - 1)];
+    tailIdx.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate when read from a third task
+  size_t size() const { return headIdx.load(std::memory_order_acquire) - tailIdx.load(std::memory_order_acquire); }
+  uint32_t overflowCount() const { return overflows.load(std::memory_order_relaxed); }
+
+private:
+  T items[N];
+  std::atomic<uint32_t> headIdx{0};
+  std::atomic<uint32_t> tailIdx{0};
+  std::atomic<uint32_t> overflows{0};
+};
@@ -0,0 +1,43 @@
+#include "trend_buffer.h"
+
+const uint32_t trendLevelPeriodMs[TREND_LEVELS] = { 1000, 10000, 60000 };
+
+void TrendLevel::push(const TrendPoint &p) {
+  points[head] = p;
+  head = (head + 1) % TREND_POINTS;
+  if (count < TREND_POINTS) count++;
+  totalPushed++;
+}
+
+void TrendLevel::add(uint32_t timeMs, int16_t value, uint32_t periodMs) {
+  uint32_t b = timeMs / periodMs;
+  if (!started) {
+    started = true;
+    bucket = b;
+    acc = { value, value };
+    return;
+  }
+
+  if (b != bucket) {
+    // Close the running bucket, then mark any silent buckets as gaps
+    push(acc);
+    uint32_t gaps = b - bucket - 1;
+    if (gaps > TREND_POINTS) gaps = TREND_POINTS;
+    for (uint32_t i = 0; i < gaps; i++) push({ TREND_NONE, TREND_NONE });
+    bucket = b;
+    acc = { value, value };
+    return;
+  }
+
+  if (value < acc.min) acc.min = value;
+  if (value > acc.max) acc.max = value;
+}
+
+TrendPoint TrendLevel::at(int i) const {
+  int idx = (head + TREND_POINTS - count + i) % TREND_POINTS;
+  return points[idx];
+}
+
+void TrendSeries::add(uint32_t timeMs, int16_t value) {
+  for (int i = 0; i < TREND_LEVELS; i++) levels[i].add(timeMs, value, trendLevelPeriodMs[i]);
+}
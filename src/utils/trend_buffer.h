@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+
+// Decimating trend history
+// Keeps one fixed-size ring of min/max points per time resolution. Each
+// level buckets the raw samples by time on its own, so a short transient
+// still shows up as a spike at the coarsest level instead of being
+// averaged away. Buckets with no samples are stored as TREND_NONE gaps.
+
+#define TREND_POINTS 120
+#define TREND_LEVELS 3
+#define TREND_NONE INT16_MIN
+
+struct TrendPoint {
+  int16_t min;
+  int16_t max;
+};
+
+// Bucket length per level; with 120 points: 2 min, 20 min, 2 h
+extern const uint32_t trendLevelPeriodMs[TREND_LEVELS];
+
+class TrendLevel {
+public:
+  void add(uint32_t timeMs, int16_t value, uint32_t periodMs);
+
+  // i = 0 is the oldest stored point
+  TrendPoint at(int i) const;
+  int size() const { return count; }
+  uint32_t pushed() const { return totalPushed; }  // Points completed since start
+
+private:
+  void push(const TrendPoint &p);
+
+  TrendPoint points[TREND_POINTS];
+  uint16_t head = 0;
+  uint16_t count = 0;
+  uint32_t totalPushed = 0;
+  uint32_t bucket = 0;
+  bool started = false;
+  TrendPoint acc;
+};
+
+class TrendSeries {
+public:
+  void add(uint32_t timeMs, int16_t value);
+  const TrendLevel &level(int i) const { return levels[i]; }
+
+private:
+  TrendLevel levels[TREND_LEVELS];
+};
@@ -25,17 +25,11 @@ void calculateUptime() {
   }
 }
 
+// The heap keeps its own low-water mark since boot, which also catches
+// dips between calls
 void monitorFreeHeap() {
-  uint32_t currentFreeHeap = ESP.getFreeHeap();
-
-  if (currentFreeHeap < minFreeHeap) {
-    minFreeHeap = currentFreeHeap;
-  }
-
-  if (millis() - lastHeapUpdate >= 1000) {
-    minFreeHeap = UINT32_MAX;
-    lastHeapUpdate = millis();
-  }
+  minFreeHeap = ESP.getMinFreeHeap();
+  lastHeapUpdate = millis();
 }
 
 // Readable display of memory sizes